@@ -113,7 +113,7 @@ namespace v2 {
 template <class OutputIterator>
 OutputIterator primes(unsigned int n, OutputIterator oiter)
 {
-    std::vecotr<bool> is_prime(n, 1);
+    std::vector<bool> is_prime(n, 1);
     is_prime[0].flip();
     is_prime[1].flip();
 
@@ -264,7 +264,7 @@ struct search_insert {
         do {
             *iter = *std::next(iter, -1);
             std::advance(iter, -1);
-        } while (!comp(iter, first) && !comp(*std::next(iter, -1), x));
+        } while (iter != first && !comp(*std::next(iter, -1), x));
         *iter = x;
     }
 };
@@ -310,7 +310,7 @@ void insertion_sort(BidirectionalIterator first, BidirectionalIterator last, Com
 }
 
 template <class BidirectionalIterator>
-insertion_sort(BidirectionalIterator first, BidirectionalIterator last)
+void insertion_sort(BidirectionalIterator first, BidirectionalIterator last)
 {
     insertion_sort(first, last, std::less<>(), search_insert());
 }
@@ -400,9 +400,9 @@ void quick_sort(BidirectionalIterator first, BidirectionalIterator last, Compare
     if (first == last) return;
     
     BidirectionalIterator l = first, r = std::next(last, -1);
-    while (l < r) {
-        for (; comp(*l, *first) && l < r; ++l);
-        for (; comp(*first, *r); --r);
+    while (l != r) {
+        for (; l != r && !comp(*r, *first); --r); // 右からピボットより小さい値を探す
+        for (; l != r && !comp(*first, *l); ++l); // 左からピボットより大きい値を探す
         std::iter_swap(l, r);
     }
     std::iter_swap(first, l);
@@ -532,12 +532,12 @@ template <class BidirectionalIterator, class Compare>
 void quick_sort(BidirectionalIterator first, BidirectionalIterator last, Compare comp)
 {
     if (first == last) return;
-    std::iter_swap(first, med3(first, std::next(first, std::distance(first, last) / 2), std::next(last, -1))); // med3 の値を first の値とスワップします.
+    std::iter_swap(first, med3_iter(first, std::next(first, std::distance(first, last) / 2), std::next(last, -1))); // med3 の値を first の値とスワップします.
 
-    Iter l = first, r = std::next(last, -1);
-    while (l < r) {
-        for (; comp(*l, *first) && l < r; ++l);
-        for (; comp(*first, *r); --r);
+    BidirectionalIterator l = first, r = std::next(last, -1);
+    while (l != r) {
+        for (; l != r && !comp(*r, *first); --r); // 右からピボットより小さい値を探す
+        for (; l != r && !comp(*first, *l); ++l); // 左からピボットより大きい値を探す
         std::iter_swap(l, r);
     }
     std::iter_swap(first, l);
@@ -603,7 +603,7 @@ ForwardIterator lower_bound(ForwardIterator first, ForwardIterator last, const T
         if (comp(*mid, val)) {
             first = mid;
             ++first;
-            len -= half - 1;
+            len -= half + 1;
         } else {
             len = half;
         }
@@ -715,4 +715,2472 @@ struct search_insert {
 } // namespace v2
 } // namespace chap16_7_1
 } // namespace TPLCXX17
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace TPLCXX17 {
+//! chapter 16.7.3 namespace
+namespace chap16_7_3 {
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+inline void prefetch(const void* p) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p);
+#else
+    static_cast<void>(p);
+#endif
+}
+
+template <class Compare, class T>
+struct is_simd_less 
+    : std::conjunction<std::is_same<T, std::int32_t>, std::disjunction<std::is_same<Compare, std::less<>>, std::is_same<Compare, std::less<T>>>> {};
+
+// [first, first + len) のうち comp(*iter, val) が真となる要素の数を分岐なしで数える
+template <class RandomAccessIterator, class T, class Compare>
+std::size_t count_before(RandomAccessIterator first, std::size_t len, const T& val, Compare comp)
+{
+    std::size_t n = 0, i = 0;
+#if defined(__SSE2__)
+    typedef std::remove_cv_t<typename std::iterator_traits<RandomAccessIterator>::value_type> value_type;
+    if constexpr (std::conjunction_v<std::is_pointer<RandomAccessIterator>, is_simd_less<Compare, value_type>, std::is_same<T, value_type>>) {
+        const __m128i key = _mm_set1_epi32(val);
+        __m128i acc = _mm_setzero_si128();
+        for (; i + 4 <= len; i += 4) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+            acc = _mm_sub_epi32(acc, _mm_cmplt_epi32(x, key)); // 真であるレーンは -1 なので、引くと 1 加算される
+        }
+        alignas(16) std::int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        n = static_cast<std::size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+#endif
+    for (; i < len; ++i) n += static_cast<bool>(comp(first[i], val));
+    return n;
+}
+
+} // namespace detail
+#endif
+
+/**
+ * @class search_result
+ * @brief batch_binary_search の結果を表します
+ */
+template <class RandomAccessIterator>
+struct search_result {
+    //! @a val 以上の値が現れる最初の位置(lower_bound と同じ位置)
+    RandomAccessIterator position;
+    //! @a val と同等の値が見つかった場合 true
+    bool found;
+};
+
+/**
+ * @brief ソート済みの範囲 @p [first, last) に対して、@p [kfirst, klast) の各値の lower_bound を求めます。
+ * 探索は @a G 個ずつ足並みを揃えて進められ、各探索の次の中央値はまとめてプリフェッチされます。
+ * 残りの範囲の長さが @a Window 以下になると、二分探索をやめて残りの要素を(可能であれば SIMD 命令で)数えます
+ * @param first 範囲の最初のイテレータ
+ * @param last 範囲の最後 + 1 のイテレータ
+ * @param kfirst 検索対象の値の範囲の最初のイテレータ
+ * @param klast 検索対象の値の範囲の最後 + 1 のイテレータ
+ * @param out 結果となるイテレータを出力する出力イテレータ
+ * @param comp bool 値へ文脈変換可能な比較関数オブジェクト
+ * @return 出力イテレータを返します
+ * @code
+ * #include <vector>
+ * #include <numeric>
+ *
+ * void batch_lower_bound_sample()
+ * {
+ *      std::vector<int> v(1000), keys { 4, 42, 999, 1000 };
+ *      std::iota(std::begin(v), std::end(v), 0);
+ *      std::vector<std::vector<int>::iterator> res;
+ *      TPLCXX17::chap16_7_3::batch_lower_bound(std::begin(v), std::end(v), std::begin(keys), std::end(keys), std::back_inserter(res));
+ * }
+ * @endcode
+ */
+template <std::size_t G = 16, std::size_t Window = 16, class RandomAccessIterator, class InputIterator, class OutputIterator, class Compare>
+OutputIterator batch_lower_bound(RandomAccessIterator first, RandomAccessIterator last, InputIterator kfirst, InputIterator klast, OutputIterator out, Compare comp)
+{
+    static_assert(G > 0 && Window > 0); // Window が 0 の場合、len が 1 から減らず終わらない
+    typedef typename std::iterator_traits<InputIterator>::value_type key_type;
+    
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    std::array<key_type, G> keys;
+    std::array<RandomAccessIterator, G> base;
+
+    while (kfirst != klast) {
+        std::size_t g = 0;
+        for (; g < G && kfirst != klast; ++g, ++kfirst) { // G 個の探索を準備する
+            keys[g] = *kfirst;
+            base[g] = first;
+        }
+
+        std::size_t len = n;
+        for (std::size_t i = 0; i < g && len > Window; ++i) detail::prefetch(&*std::next(base[i], len / 2));
+        while (len > Window) { // 全ての探索で len は同じように変化する
+            const std::size_t half = len / 2;
+            len -= half;
+            for (std::size_t i = 0; i < g; ++i) {
+                base[i] = comp(base[i][half], keys[i]) ? std::next(base[i], half) : base[i];
+                detail::prefetch(&*std::next(base[i], len / 2)); // 次の中央値の読み込みを先に発行しておく
+            }
+        }
+        for (std::size_t i = 0; i < g; ++i) *out++ = std::next(base[i], detail::count_before(base[i], len, keys[i], comp));
+    }
+    return out;
+}
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <std::size_t G = 16, std::size_t Window = 16, class RandomAccessIterator, class InputIterator, class OutputIterator>
+OutputIterator batch_lower_bound(RandomAccessIterator first, RandomAccessIterator last, InputIterator kfirst, InputIterator klast, OutputIterator out)
+{
+    return batch_lower_bound<G, Window>(first, last, kfirst, klast, out, std::less<>());
+}
+#endif
+
+/**
+ * @brief ソート済みの範囲 @p [first, last) に @p [kfirst, klast) の各値が存在するかどうかを、batch_lower_bound を利用してまとめて判定します
+ * @param first 範囲の最初のイテレータ
+ * @param last 範囲の最後 + 1 のイテレータ
+ * @param kfirst 検索対象の値の範囲の最初のイテレータ
+ * @param klast 検索対象の値の範囲の最後 + 1 のイテレータ
+ * @param out search_result を出力する出力イテレータ
+ * @param comp bool 値へ文脈変換可能な比較関数オブジェクト
+ * @return 出力イテレータを返します
+ * @code
+ * #include <vector>
+ * #include <numeric>
+ * #include <utility>
+ *
+ * void batch_binary_search_sample()
+ * {
+ *      std::vector<int> v(1000), keys { 4, 42, 999, 1000 };
+ *      std::iota(std::begin(v), std::end(v), 0);
+ *      std::vector<TPLCXX17::chap16_7_3::search_result<const int*>> res;
+ *      TPLCXX17::chap16_7_3::batch_binary_search(std::data(std::as_const(v)), std::data(std::as_const(v)) + v.size(), std::begin(keys), std::end(keys), std::back_inserter(res)); // SIMD による比較が行われる
+ * }
+ * @endcode
+ */
+template <std::size_t G = 16, std::size_t Window = 16, class RandomAccessIterator, class InputIterator, class OutputIterator, class Compare>
+OutputIterator batch_binary_search(RandomAccessIterator first, RandomAccessIterator last, InputIterator kfirst, InputIterator klast, OutputIterator out, Compare comp)
+{
+    static_assert(G > 0 && Window > 0);
+    typedef typename std::iterator_traits<InputIterator>::value_type key_type;
+
+    std::array<key_type, G> keys;
+    std::array<RandomAccessIterator, G> pos;
+    while (kfirst != klast) {
+        std::size_t g = 0;
+        for (; g < G && kfirst != klast; ++g, ++kfirst) keys[g] = *kfirst;
+        batch_lower_bound<G, Window>(first, last, std::begin(keys), std::next(std::begin(keys), g), std::begin(pos), comp);
+        for (std::size_t i = 0; i < g; ++i) {
+            *out++ = search_result<RandomAccessIterator> { pos[i], pos[i] != last && !comp(keys[i], *pos[i]) }; // == v1::binary_search と同じ判定
+        }
+    }
+    return out;
+}
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <std::size_t G = 16, std::size_t Window = 16, class RandomAccessIterator, class InputIterator, class OutputIterator>
+OutputIterator batch_binary_search(RandomAccessIterator first, RandomAccessIterator last, InputIterator kfirst, InputIterator klast, OutputIterator out)
+{
+    return batch_binary_search<G, Window>(first, last, kfirst, klast, out, std::less<>());
+}
+#endif
+
+} // namespace chap16_7_3
+} // namespace TPLCXX17
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace TPLCXX17 {
+//! chapter 16.7.4 namespace
+namespace chap16_7_4 {
+
+/**
+ * @class learned_index
+ * @brief ソート済みの範囲に対する 2 段階の区分線形モデルによる学習済みインデックス。範囲の要素は所有せず、参照のみを行います
+ * @code
+ * #include <vector>
+ * #include <numeric>
+ *
+ * void learned_index_sample()
+ * {
+ *      std::vector<std::uint64_t> v(100000);
+ *      std::iota(std::begin(v), std::end(v), 1000);
+ *      TPLCXX17::chap16_7_4::learned_index index(std::begin(v), std::end(v));
+ *      [[maybe_unused]] auto iter = index.lower_bound(42000);
+ *      [[maybe_unused]] bool res = index.binary_search(42000);
+ * }
+ * @endcode
+ */
+template <class RandomAccessIterator>
+class learned_index {
+public:
+    //! 要素の型
+    typedef std::remove_cv_t<typename std::iterator_traits<RandomAccessIterator>::value_type> value_type;
+    static_assert(std::is_arithmetic_v<value_type>);
+private:
+    /**
+     * @class segment
+     * @brief 2 段目のモデル。@a origin からの差に対する直線と、予測値に対する誤差の上限を保持します
+     */
+    struct segment {
+        value_type origin;
+        double slope, intercept;
+        std::uint32_t err_lo, err_hi; // 実際の位置は [予測値 - err_lo, 予測値 + err_hi] の範囲にあります
+    };
+
+    static double offset(value_type x, value_type origin) noexcept // 整数型の場合、桁落ちしないように差を取ってから double に変換する
+    {
+        if constexpr (std::is_integral_v<value_type>) {
+            // 符号付きの場合、差が value_type に収まらないことがあるため、対応する符号なしの型で差を取る
+            typedef std::make_unsigned_t<value_type> unsigned_type;
+            return x < origin ? -static_cast<double>(static_cast<unsigned_type>(static_cast<unsigned_type>(origin) - static_cast<unsigned_type>(x)))
+                              : static_cast<double>(static_cast<unsigned_type>(static_cast<unsigned_type>(x) - static_cast<unsigned_type>(origin)));
+        } else {
+            return x < origin ? -static_cast<double>(origin - x) : static_cast<double>(x - origin);
+        }
+    }
+
+    std::size_t route(value_type x) const noexcept // 1 段目のモデル
+    {
+        if (!(min_ < x)) return 0;
+        const double s = offset(x, min_) * root_slope_;
+        return s < static_cast<double>(segments_.size() - 1) ? static_cast<std::size_t>(s) : segments_.size() - 1;
+    }
+
+    std::size_t predict(const segment& seg, value_type x) const noexcept // 2 段目のモデル
+    {
+        const double p = std::round(seg.slope * offset(x, seg.origin) + seg.intercept);
+        return p < 0 ? 0 : p > static_cast<double>(size_) ? size_ : static_cast<std::size_t>(p);
+    }
+public:
+    /**
+     * @brief ソート済みの範囲 @p [first, last) からモデルを学習します。時間計算量は @f$ O(N) @f$ です
+     * @param first 範囲の最初のイテレータ
+     * @param last 範囲の最後 + 1 のイテレータ
+     * @param segments 2 段目のモデルの数
+     */
+    learned_index(RandomAccessIterator first, RandomAccessIterator last, std::size_t segments = 256)
+        : first_(first), last_(last), size_(static_cast<std::size_t>(std::distance(first, last))), segments_(std::max(segments, std::size_t(1)))
+    {
+        if (!size_) return;
+        min_ = *first_;
+        const double range = offset(*std::next(last_, -1), min_);
+        root_slope_ = range > 0 ? static_cast<double>(segments_.size()) / range : 0;
+
+        for (std::size_t b = 0, s = 0; s < segments_.size(); ++s) {
+            std::size_t e = b;
+            while (e < size_ && route(first_[e]) == s) ++e; // 1 段目のモデルは単調なので、各セグメントに属する要素は連続する
+            fit(segments_[s], b, e);
+            b = e;
+        }
+    }
+
+    /**
+     * @brief 指定された要素以上の値が現れる最初のイテレータを取得します。この関数は std::lower_bound と同等です
+     * @param val 検索対象の値
+     * @return @a val 以上の要素のうち最初のものを指すイテレータを返します。@a val 以上の要素がない場合、範囲の最後 + 1 のイテレータを返します
+     */
+    RandomAccessIterator lower_bound(value_type val) const
+    {
+        if (!size_) return last_;
+        const segment& seg = segments_[route(val)];
+        const std::size_t p = predict(seg, val);
+        const std::size_t lo = p > seg.err_lo ? p - seg.err_lo : 0, hi = std::min(size_, p + seg.err_hi + 1);
+
+        RandomAccessIterator iter = chap16_7_1::v1::lower_bound(std::next(first_, lo), std::next(first_, hi), val);
+        // val が学習した範囲のどの値とも異なる場合、予測が誤差の上限を超えることがあります。その場合は残りの範囲を探索します
+        if (lo && iter == std::next(first_, lo) && !(first_[lo - 1] < val)) return chap16_7_1::v1::lower_bound(first_, std::next(first_, lo), val);
+        if (hi < size_ && iter == std::next(first_, hi)) return chap16_7_1::v1::lower_bound(iter, last_, val);
+        return iter;
+    }
+
+    /**
+     * @brief 要素が範囲内に存在するかどうか判定します。この関数は std::binary_search と同等です
+     * @param val 検索対象の値
+     * @return @a val と同等の値が範囲にある場合は true 、そうでない場合は false を返します
+     */
+    bool binary_search(value_type val) const
+    {
+        RandomAccessIterator iter = lower_bound(val);
+        return iter != last_ && !(val < *iter);
+    }
+
+    /**
+     * @brief セグメントの誤差の上限のうち、最大のものを返します
+     * @return 誤差の上限の最大値
+     */
+    std::size_t max_error() const noexcept
+    {
+        std::size_t r = 0;
+        for (const segment& seg : segments_) r = std::max<std::size_t>(r, seg.err_lo + seg.err_hi);
+        return r;
+    }
+
+    /**
+     * @brief インデックスが利用しているメモリのバイト数を返します
+     * @return バイト数
+     */
+    std::size_t size_in_bytes() const noexcept
+    {
+        return sizeof *this + segments_.size() * sizeof(segment);
+    }
+private:
+    void fit(segment& seg, std::size_t b, std::size_t e) // [b, e) の要素の位置を最小二乗法で近似する
+    {
+        seg = segment { b < e ? first_[b] : min_, 0, static_cast<double>(b), 0, 0 };
+        if (e - b < 2) return;
+
+        const double n = static_cast<double>(e - b);
+        double sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (std::size_t i = b; i < e; ++i) {
+            const double x = offset(first_[i], seg.origin), y = static_cast<double>(i);
+            sx += x;
+            sy += y;
+            sxx += x * x;
+            sxy += x * y;
+        }
+        const double d = n * sxx - sx * sx;
+        if (d > 0) {
+            seg.slope = (n * sxy - sx * sy) / d;
+            seg.intercept = (sy - seg.slope * sx) / n;
+        }
+
+        for (std::size_t i = b; i < e; ++i) {
+            const std::size_t p = predict(seg, first_[i]);
+            const std::size_t j = i == b || first_[i - 1] < first_[i] ? i : j_of(i); // 重複した値の lower_bound は最初の位置
+            if (p > j) seg.err_lo = std::max<std::uint32_t>(seg.err_lo, static_cast<std::uint32_t>(p - j));
+            else seg.err_hi = std::max<std::uint32_t>(seg.err_hi, static_cast<std::uint32_t>(j - p));
+        }
+    }
+
+    std::size_t j_of(std::size_t i) const
+    {
+        return static_cast<std::size_t>(std::distance(first_, chap16_7_1::v1::lower_bound(first_, std::next(first_, i), first_[i])));
+    }
+
+    RandomAccessIterator first_, last_;
+    std::size_t size_;
+    value_type min_ {};
+    double root_slope_ = 0;
+    std::vector<segment> segments_;
+};
+
+} // namespace chap16_7_4
+} // namespace TPLCXX17
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace TPLCXX17 {
+namespace chap16_7_4 {
+
+/**
+ * @class eytzinger_layout
+ * @brief ソート済みの列を Eytzinger 配置に並べ直して保持し、その上で探索を行います
+ * @code
+ * #include <vector>
+ * #include <numeric>
+ *
+ * void eytzinger_layout_sample()
+ * {
+ *      std::vector<int> v(1000);
+ *      std::iota(std::begin(v), std::end(v), 0);
+ *      TPLCXX17::chap16_7_4::eytzinger_layout<int> e(std::begin(v), std::end(v));
+ *      [[maybe_unused]] const int* p = e.lower_bound(42); // *p == 42
+ * }
+ * @endcode
+ */
+template <class T>
+class eytzinger_layout {
+public:
+    /**
+     * @brief ソート済みの範囲 @p [first, last) を Eytzinger 配置に並べ直します
+     * @param first 範囲の最初のイテレータ
+     * @param last 範囲の最後 + 1 のイテレータ
+     */
+    template <class RandomAccessIterator>
+    eytzinger_layout(RandomAccessIterator first, RandomAccessIterator last)
+        : data_(static_cast<std::size_t>(std::distance(first, last)) + 1)
+    {
+        build(first, 1);
+    }
+
+    /**
+     * @brief 指定された要素以上の値のうち最小のものを取得します
+     * @param val 検索対象の値
+     * @return @a val 以上の要素のうち最小のものを指すポインタを返します。@a val 以上の要素がない場合 nullptr を返します
+     */
+    const T* lower_bound(const T& val) const
+    {
+        const std::size_t n = data_.size() - 1;
+        std::size_t k = 1;
+        while (k <= n) {
+            if (16 * k <= n) chap16_7_3::detail::prefetch(&data_[16 * k]); // 4 段先の読み込みを先に発行しておく
+            k = 2 * k + (data_[k] < val);
+        }
+        while (k & 1) k >>= 1; // 最後に左の子へ進んだ位置まで戻る
+        k >>= 1;
+        return k ? &data_[k] : nullptr;
+    }
+private:
+    template <class RandomAccessIterator>
+    RandomAccessIterator build(RandomAccessIterator iter, std::size_t k) // 二分木を中間順で辿りながら、ソート済みの列を順に割り当てる
+    {
+        if (k < data_.size()) {
+            iter = build(iter, 2 * k);
+            data_[k] = *iter++;
+            iter = build(iter, 2 * k + 1);
+        }
+        return iter;
+    }
+
+    std::vector<T> data_;
+};
+
+} // namespace chap16_7_4
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+template <class F>
+double ns_per_lookup(const std::vector<std::uint64_t>& keys, F f)
+{
+    std::size_t found = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t k : keys) found += f(k);
+    const std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    if (found != keys.size()) std::cerr << "error: lookup failed" << std::endl;
+    return d.count() / keys.size();
+}
+
+template <class Gen>
+void bench(const char* name, std::size_t n, Gen gen)
+{
+    std::mt19937_64 mt(42);
+    std::vector<std::uint64_t> v(n);
+    for (auto& x : v) x = gen(mt);
+    std::sort(std::begin(v), std::end(v));
+
+    std::vector<std::uint64_t> keys(1 << 20);
+    for (auto& k : keys) k = v[mt() % n];
+
+    TPLCXX17::chap16_7_4::learned_index index(std::begin(v), std::end(v));
+    TPLCXX17::chap16_7_4::eytzinger_layout<std::uint64_t> eytzinger(std::begin(v), std::end(v));
+
+    std::cout << name << ": index " << index.size_in_bytes() << " bytes, max error " << index.max_error() << std::endl;
+    std::cout << "  v1::lower_bound: " << ns_per_lookup(keys, [&](std::uint64_t k) { return TPLCXX17::chap16_7_1::v1::binary_search(std::begin(v), std::end(v), k); }) << " ns" << std::endl;
+    std::cout << "  eytzinger:       " << ns_per_lookup(keys, [&](std::uint64_t k) { const std::uint64_t* p = eytzinger.lower_bound(k); return p && *p == k; }) << " ns" << std::endl;
+    std::cout << "  learned_index:   " << ns_per_lookup(keys, [&](std::uint64_t k) { return index.binary_search(k); }) << " ns" << std::endl;
+}
+
+int main()
+{
+    constexpr std::size_t n = 1 << 24;
+    bench("uniform", n, [](auto& mt) { return std::uniform_int_distribution<std::uint64_t>(0, std::uint64_t(1) << 48)(mt); });
+    bench("lognormal", n, [d = std::lognormal_distribution<double>(0, 2)](auto& mt) mutable { return static_cast<std::uint64_t>(d(mt) * 1e9); });
+    bench("timestamp", n, [t = std::uint64_t(1500000000000), e = std::exponential_distribution<double>(0.01)](auto& mt) mutable {
+        return t += static_cast<std::uint64_t>(e(mt)) + (mt() % 1024 ? 0 : 3600000); // ミリ秒単位、時々 1 時間の空白がある
+    });
+}
+#endif
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TPLCXX17 {
+//! chapter 16.7.5 namespace
+namespace chap16_7_5 {
+
+//! ファイル形式のバージョン。形式を変更した場合は値を増やします
+inline constexpr std::uint32_t table_version = 1;
+
+/**
+ * @class table_header
+ * @brief ソート済みの表のファイルの先頭に置かれるヘッダ
+ */
+struct table_header {
+    char magic[8];               //!< "TPLCXX17"
+    std::uint32_t version;       //!< table_version
+    std::uint32_t byte_order;    //!< 0x01020304。書き込んだ環境とバイトオーダーが異なる場合、値が異なって読めます
+    std::uint32_t key_size;      //!< キーの型のサイズ
+    std::uint32_t payload_size;  //!< 値の型のサイズ
+    std::uint64_t count;         //!< 要素数
+    std::uint64_t stride;        //!< 索引層の間隔
+    std::uint64_t fence_offset;  //!< 索引層のオフセット
+    std::uint64_t key_offset;    //!< キーの列のオフセット
+    std::uint64_t payload_offset;//!< 値の列のオフセット
+    std::uint64_t file_size;     //!< ファイル全体のサイズ
+    std::uint64_t checksum;      //!< ヘッダより後ろ全体の FNV-1a ハッシュ値
+};
+static_assert(std::is_trivially_copyable_v<table_header>);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+inline constexpr char magic[8] = { 'T', 'P', 'L', 'C', 'X', 'X', '1', '7' };
+inline constexpr std::uint64_t alignment = 64;
+
+constexpr std::uint64_t align(std::uint64_t x) noexcept { return (x + alignment - 1) / alignment * alignment; }
+
+inline std::uint64_t fnv1a(const unsigned char* first, const unsigned char* last, std::uint64_t h = 0xcbf29ce484222325) noexcept
+{
+    for (; first != last; ++first) h = (h ^ *first) * 0x100000001b3;
+    return h;
+}
+
+} // namespace detail
+#endif
+
+/**
+ * @brief キーと値の組の範囲を、キーについて v1::merge_sort でソートし、索引層を付けて @a path に書き出します
+ * @param path 書き出すファイルのパス
+ * @param first std::pair<Key, Payload> に変換可能な要素の範囲の最初のイテレータ
+ * @param last 範囲の最後 + 1 のイテレータ
+ * @param stride 索引層の間隔
+ * @return なし
+ * @exception std::runtime_error 書き込みに失敗した場合に送出されます
+ * @code
+ * #include <vector>
+ * #include <utility>
+ *
+ * void write_sorted_table_sample()
+ * {
+ *      std::vector<std::pair<std::uint64_t, double>> v { { 3, 0.3 }, { 1, 0.1 }, { 2, 0.2 } };
+ *      TPLCXX17::chap16_7_5::write_sorted_table<std::uint64_t, double>("table.bin", std::begin(v), std::end(v));
+ * }
+ * @endcode
+ */
+template <class Key, class Payload, class InputIterator>
+void write_sorted_table(const std::string& path, InputIterator first, InputIterator last, std::size_t stride = 64)
+{
+    static_assert(std::conjunction_v<std::is_trivially_copyable<Key>, std::is_trivially_copyable<Payload>>);
+    if (!stride) throw std::invalid_argument(__func__ + std::string(": stride must not be zero"));
+
+    std::vector<std::pair<Key, Payload>> v(first, last);
+    chap16_7_1::v1::merge_sort(std::begin(v), std::end(v), [](const auto& x, const auto& y) { return x.first < y.first; });
+
+    std::vector<Key> keys, fences;
+    std::vector<Payload> payloads;
+    keys.reserve(v.size());
+    payloads.reserve(v.size());
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        keys.push_back(v[i].first);
+        payloads.push_back(v[i].second);
+        if (!(i % stride)) fences.push_back(v[i].first);
+    }
+
+    table_header h {};
+    std::memcpy(h.magic, detail::magic, sizeof h.magic);
+    h.version = table_version;
+    h.byte_order = 0x01020304;
+    h.key_size = sizeof(Key);
+    h.payload_size = sizeof(Payload);
+    h.count = keys.size();
+    h.stride = stride;
+    h.fence_offset = detail::align(sizeof h);
+    h.key_offset = detail::align(h.fence_offset + fences.size() * sizeof(Key));
+    h.payload_offset = detail::align(h.key_offset + keys.size() * sizeof(Key));
+    h.file_size = h.payload_offset + payloads.size() * sizeof(Payload);
+
+    std::vector<unsigned char> body(h.file_size - sizeof h); // ヘッダより後ろをメモリ上で組み立てる
+    if (!keys.empty()) {
+        std::memcpy(body.data() + (h.fence_offset - sizeof h), fences.data(), fences.size() * sizeof(Key));
+        std::memcpy(body.data() + (h.key_offset - sizeof h), keys.data(), keys.size() * sizeof(Key));
+        std::memcpy(body.data() + (h.payload_offset - sizeof h), payloads.data(), payloads.size() * sizeof(Payload));
+    }
+    h.checksum = detail::fnv1a(body.data(), body.data() + body.size());
+
+    // 既存のファイルを mmap している mapped_sorted_table が SIGBUS を受けないよう、
+    // 同じディレクトリの一時ファイルに書き出してから rename で置き換える
+    const std::string tmp = path + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char*>(&h), sizeof h);
+        ofs.write(reinterpret_cast<const char*>(body.data()), body.size());
+        ofs.close();
+        if (!ofs) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error(__func__ + std::string(": failed to write ") + path);
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str())) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error(__func__ + std::string(": failed to replace ") + path);
+    }
+}
+
+/**
+ * @class mapped_sorted_table
+ * @brief write_sorted_table で書き出されたファイルを mmap によってマップし、その上で直接探索を行います
+ * @code
+ * void mapped_sorted_table_sample()
+ * {
+ *      TPLCXX17::chap16_7_5::mapped_sorted_table<std::uint64_t, double> table("table.bin");
+ *      if (const double* p = table.find(2)) {
+ *          // *p == 0.2
+ *      }
+ * }
+ * @endcode
+ */
+template <class Key, class Payload>
+class mapped_sorted_table {
+    static_assert(std::conjunction_v<std::is_trivially_copyable<Key>, std::is_trivially_copyable<Payload>>);
+public:
+    /**
+     * @brief @a path をマップし、ヘッダを検証します。@a verify が false である場合、時間計算量は @f$ O(1) @f$ です
+     * @param path ファイルのパス
+     * @param verify true である場合、チェックサムも検証します(時間計算量は @f$ O(N) @f$ となります)
+     * @exception std::system_error ファイルのオープン、マップに失敗した場合に送出されます
+     * @exception std::runtime_error ファイルの形式が正しくない場合に送出されます
+     */
+    explicit mapped_sorted_table(const std::string& path, bool verify = false)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), path);
+        struct stat st;
+        if (::fstat(fd, &st) < 0) {
+            const int e = errno;
+            ::close(fd);
+            throw std::system_error(e, std::generic_category(), path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ < sizeof(table_header)) {
+            ::close(fd);
+            throw std::runtime_error(path + ": too small to be a sorted table");
+        }
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0); // 全プロセスでページを共有する
+        const int e = errno;
+        ::close(fd); // マップした後はファイル記述子は不要
+        if (p == MAP_FAILED) throw std::system_error(e, std::generic_category(), path);
+        base_ = static_cast<const unsigned char*>(p);
+
+        try {
+            validate(path, verify);
+        } catch (...) {
+            ::munmap(const_cast<unsigned char*>(base_), size_);
+            throw;
+        }
+    }
+
+    mapped_sorted_table(const mapped_sorted_table&) = delete;
+    mapped_sorted_table& operator=(const mapped_sorted_table&) = delete;
+
+    mapped_sorted_table(mapped_sorted_table&& other) noexcept
+        : base_(std::exchange(other.base_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    mapped_sorted_table& operator=(mapped_sorted_table&& other) noexcept
+    {
+        if (this != &other) {
+            if (base_) ::munmap(const_cast<unsigned char*>(base_), size_);
+            base_ = std::exchange(other.base_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~mapped_sorted_table()
+    {
+        if (base_) ::munmap(const_cast<unsigned char*>(base_), size_);
+    }
+
+    /**
+     * @brief 要素数を返します
+     * @return 要素数
+     */
+    std::size_t size() const noexcept { return static_cast<std::size_t>(header().count); }
+
+    /**
+     * @brief ソート済みのキーの列の先頭を返します
+     * @return キーの列の先頭を指すポインタ
+     */
+    const Key* keys() const noexcept { return reinterpret_cast<const Key*>(base_ + header().key_offset); }
+
+    /**
+     * @brief 値の列の先頭を返します
+     * @return 値の列の先頭を指すポインタ
+     */
+    const Payload* payloads() const noexcept { return reinterpret_cast<const Payload*>(base_ + header().payload_offset); }
+
+    /**
+     * @brief 索引層とキーの列を順に二分探索し、@a key 以上のキーが現れる最初の位置を求めます
+     * @param key 検索対象のキー
+     * @return @a key 以上のキーのうち最初のものの添字を返します。そのようなキーがない場合 size() を返します
+     */
+    std::size_t lower_bound(const Key& key) const
+    {
+        const table_header& h = header();
+        const Key* fences = reinterpret_cast<const Key*>(base_ + h.fence_offset);
+        const std::size_t nf = static_cast<std::size_t>((h.count + h.stride - 1) / h.stride);
+        const std::size_t f = chap16_7_1::v1::lower_bound(fences, fences + nf, key) - fences;
+        
+        // fences[f] はキーの列の f * stride 番目と同じ値なので、求める位置は ((f - 1) * stride, f * stride] にある
+        const std::size_t lo = f ? (f - 1) * h.stride : 0, hi = f < nf ? f * h.stride : h.count;
+        return chap16_7_1::v1::lower_bound(keys() + lo, keys() + hi, key) - keys();
+    }
+
+    /**
+     * @brief @a key に対応する値を検索します
+     * @param key 検索対象のキー
+     * @return @a key に対応する値を指すポインタを返します。見つからない場合 nullptr を返します
+     */
+    const Payload* find(const Key& key) const
+    {
+        const std::size_t i = lower_bound(key);
+        return i != size() && !(key < keys()[i]) ? payloads() + i : nullptr;
+    }
+
+    /**
+     * @brief チェックサムを検証します。時間計算量は @f$ O(N) @f$ です
+     * @return チェックサムが一致した場合 true を返します
+     */
+    bool verify() const noexcept
+    {
+        return detail::fnv1a(base_ + sizeof(table_header), base_ + size_) == header().checksum;
+    }
+private:
+    const table_header& header() const noexcept { return *reinterpret_cast<const table_header*>(base_); }
+
+    void validate(const std::string& path, bool checksum) const
+    {
+        const table_header& h = header();
+        const auto fail = [&path](const char* what) { throw std::runtime_error(path + ": " + what); };
+
+        if (std::memcmp(h.magic, detail::magic, sizeof h.magic)) fail("not a sorted table");
+        if (h.version != table_version) fail("unsupported version");
+        if (h.byte_order != 0x01020304) fail("byte order mismatch");
+        if (h.key_size != sizeof(Key) || h.payload_size != sizeof(Payload)) fail("key or payload type mismatch");
+        if (!h.stride || h.file_size != size_) fail("truncated or corrupted");
+
+        // 各領域 [offset, offset + n * size) が次の領域の先頭 last までに収まるかを、溢れないように検証する
+        const auto fits = [](std::uint64_t offset, std::uint64_t n, std::uint64_t size, std::uint64_t last) {
+            return offset <= last && n <= (last - offset) / size;
+        };
+        const std::uint64_t fences = h.count / h.stride + (h.count % h.stride != 0);
+        if (!(sizeof h <= h.fence_offset && h.fence_offset <= h.key_offset && h.key_offset <= h.payload_offset && h.payload_offset <= size_)) fail("corrupted region offsets");
+        if (h.fence_offset % alignof(Key) || h.key_offset % alignof(Key) || h.payload_offset % alignof(Payload)) fail("misaligned region offsets");
+        if (!fits(h.fence_offset, fences, sizeof(Key), h.key_offset) || !fits(h.key_offset, h.count, sizeof(Key), h.payload_offset)
+            || !fits(h.payload_offset, h.count, sizeof(Payload), size_)) fail("truncated or corrupted");
+        if (checksum && !verify()) fail("checksum mismatch");
+    }
+
+    const unsigned char* base_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace chap16_7_5
+} // namespace TPLCXX17
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace TPLCXX17 {
+//! chapter 16.7.6 namespace
+namespace chap16_7_6 {
+
+//! 長い方の列が短い方の列のこの倍数より長い場合、ギャロッピングを利用します
+inline constexpr std::size_t gallop_ratio = 32;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+// first から間隔を倍にしながら進み、val 以上の値が現れる最初の位置を求める
+template <class RandomAccessIterator, class T, class Compare>
+RandomAccessIterator gallop(RandomAccessIterator first, RandomAccessIterator last, const T& val, Compare comp)
+{
+    typedef typename std::iterator_traits<RandomAccessIterator>::difference_type diff_type;
+
+    const diff_type n = std::distance(first, last);
+    if (!n || !comp(*first, val)) return first;
+    diff_type lo = 0, hi = 1;
+    for (; hi < n && comp(first[hi], val); hi <<= 1) lo = hi;
+    return chap16_7_1::v1::lower_bound(std::next(first, lo + 1), std::next(first, std::min(hi, n)), val, comp); // 求める位置は (lo, hi] にある
+}
+
+template <class Iterator, class Compare, class T = std::remove_cv_t<typename std::iterator_traits<Iterator>::value_type>>
+struct is_simd_intersectable
+    : std::conjunction<
+        std::is_pointer<Iterator>,
+        std::disjunction<std::is_same<T, std::uint32_t>, std::is_same<T, std::uint64_t>>,
+        std::disjunction<std::is_same<Compare, std::less<>>, std::is_same<Compare, std::less<T>>>
+    > {};
+
+// p が指す値と等しい値が、[first, last) の中で p の隣にあるか
+template <class T>
+bool has_equal_neighbour(const T* first, const T* p, const T* last) noexcept
+{
+    return (p != first && p[-1] == *p) || (p + 1 != last && p[1] == *p);
+}
+
+} // namespace detail
+#endif
+
+/**
+ * @brief ソート済みの 2 つの列の積集合を、SIMD 命令によるブロック比較で求めます。
+ * 重複した値を含む場合も、std::set_intersection と同じく各値を少ない方の列の個数だけ出力します
+ * @param first1 1 つ目の範囲の最初のポインタ
+ * @param last1 1 つ目の範囲の最後 + 1 のポインタ
+ * @param first2 2 つ目の範囲の最初のポインタ
+ * @param last2 2 つ目の範囲の最後 + 1 のポインタ
+ * @param out 出力イテレータ
+ * @return 出力イテレータを返します
+ * @code
+ * #include <vector>
+ *
+ * void simd_intersection_sample()
+ * {
+ *      std::vector<std::uint32_t> a { 1, 3, 5, 7, 9 }, b { 2, 3, 4, 5, 6 }, res;
+ *      TPLCXX17::chap16_7_6::simd_intersection(std::data(a), std::data(a) + a.size(), std::data(b), std::data(b) + b.size(), std::back_inserter(res)); // 3, 5
+ * }
+ * @endcode
+ */
+template <class T, class OutputIterator>
+OutputIterator simd_intersection(const T* first1, const T* last1, const T* first2, const T* last2, OutputIterator out)
+{
+    static_assert(std::disjunction_v<std::is_same<T, std::uint32_t>, std::is_same<T, std::uint64_t>>);
+
+    const T* const begin1 = first1;
+    const T* const begin2 = first2;
+    // ブロック内で一致した値 *p を出力する。その値がどちらかの列で重複している場合は、その値の区間だけを通常の方法で出力し、
+    // 両方の列をその値の直後まで進めて false を返す(両方の列がその値で分かれるため、そこからブロック比較をやり直せる)
+    auto emit = [&](const T* p, std::size_t width) {
+        const T* const q = std::find(first2, first2 + width, *p);
+        if (!detail::has_equal_neighbour(begin1, p, last1) && !detail::has_equal_neighbour(begin2, q, last2)) {
+            *out++ = *p;
+            return true;
+        }
+        const T* const lo1 = std::lower_bound(begin1, p, *p);
+        const T* const lo2 = std::lower_bound(begin2, q, *p);
+        first1 = std::upper_bound(p, last1, *p);
+        first2 = std::upper_bound(q, last2, *q);
+        out = std::copy_n(lo1, std::min(first1 - lo1, first2 - lo2), out);
+        return false;
+    };
+
+#if defined(__SSE2__)
+    if constexpr (sizeof(T) == sizeof(std::uint32_t)) {
+        while (last1 - first1 >= 4 && last2 - first2 >= 4) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first1));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first2));
+            const __m128i eq = _mm_or_si128( // va の各要素と、vb を 0 から 3 要素回転させたものを比較する
+                _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))))
+            );
+            const int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+            bool restart = false;
+            for (int l = 0; l < 4 && !restart; ++l) {
+                if (mask & (1 << l)) restart = !emit(first1 + l, 4);
+            }
+            if (restart) continue;
+
+            const T amax = first1[3], bmax = first2[3];
+            if (!(bmax < amax)) first1 += 4;
+            if (!(amax < bmax)) first2 += 4;
+        }
+    }
+#endif
+#if defined(__SSE4_1__)
+    if constexpr (sizeof(T) == sizeof(std::uint64_t)) {
+        while (last1 - first1 >= 2 && last2 - first2 >= 2) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first1));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first2));
+            const __m128i eq = _mm_or_si128(_mm_cmpeq_epi64(va, vb), _mm_cmpeq_epi64(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+            const int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+            if ((mask & 1) && !emit(first1, 2)) continue;
+            if ((mask & 2) && !emit(first1 + 1, 2)) continue;
+
+            const T amax = first1[1], bmax = first2[1];
+            if (!(bmax < amax)) first1 += 2;
+            if (!(amax < bmax)) first2 += 2;
+        }
+    }
+#endif
+    return std::set_intersection(first1, last1, first2, last2, out); // 残りの部分
+}
+
+/**
+ * @brief ソート済みの 2 つの列の積集合を、短い方の列の各要素を長い方の列からギャロッピングで探索することで求めます。
+ * 時間計算量は @f$ O(m \log (n / m)) @f$ です
+ * @param first1 短い方の範囲の最初のイテレータ
+ * @param last1 短い方の範囲の最後 + 1 のイテレータ
+ * @param first2 長い方の範囲の最初のイテレータ
+ * @param last2 長い方の範囲の最後 + 1 のイテレータ
+ * @param out 出力イテレータ
+ * @param comp bool 値へ文脈変換可能な比較関数オブジェクト
+ * @return 出力イテレータを返します
+ */
+template <class InputIterator, class RandomAccessIterator, class OutputIterator, class Compare>
+OutputIterator galloping_intersection(InputIterator first1, InputIterator last1, RandomAccessIterator first2, RandomAccessIterator last2, OutputIterator out, Compare comp)
+{
+    for (; first1 != last1 && first2 != last2; ++first1) {
+        first2 = detail::gallop(first2, last2, *first1, comp);
+        if (first2 != last2 && !comp(*first1, *first2)) {
+            *out++ = *first1;
+            ++first2;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief ソート済みの 2 つの列の和集合を、短い方の列の各要素の間に挟まれた長い方の列の部分をギャロッピングで求めてまとめて出力することで求めます
+ * @param first1 短い方の範囲の最初のイテレータ
+ * @param last1 短い方の範囲の最後 + 1 のイテレータ
+ * @param first2 長い方の範囲の最初のイテレータ
+ * @param last2 長い方の範囲の最後 + 1 のイテレータ
+ * @param out 出力イテレータ
+ * @param comp bool 値へ文脈変換可能な比較関数オブジェクト
+ * @return 出力イテレータを返します
+ */
+template <class InputIterator, class RandomAccessIterator, class OutputIterator, class Compare>
+OutputIterator galloping_union(InputIterator first1, InputIterator last1, RandomAccessIterator first2, RandomAccessIterator last2, OutputIterator out, Compare comp)
+{
+    for (; first1 != last1; ++first1) {
+        RandomAccessIterator pos = detail::gallop(first2, last2, *first1, comp);
+        out = std::copy(first2, pos, out);
+        first2 = pos;
+        if (first2 != last2 && !comp(*first1, *first2)) ++first2; // 同じ値は一度だけ出力する
+        *out++ = *first1;
+    }
+    return std::copy(first2, last2, out);
+}
+
+/**
+ * @brief ソート済みの 2 つの列の差集合 @p [first1, last1) - @p [first2, last2) を、長い方の列をギャロッピングで探索することで求めます
+ * @param first1 1 つ目の範囲の最初のイテレータ
+ * @param last1 1 つ目の範囲の最後 + 1 のイテレータ
+ * @param first2 2 つ目の範囲の最初のイテレータ
+ * @param last2 2 つ目の範囲の最後 + 1 のイテレータ
+ * @param out 出力イテレータ
+ * @param comp bool 値へ文脈変換可能な比較関数オブジェクト
+ * @return 出力イテレータを返します
+ */
+template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator, class Compare>
+OutputIterator galloping_difference(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator2 first2, RandomAccessIterator2 last2, OutputIterator out, Compare comp)
+{
+    if (std::distance(first1, last1) <= std::distance(first2, last2)) { // 1 つ目の各要素を 2 つ目から探す
+        for (; first1 != last1; ++first1) {
+            first2 = detail::gallop(first2, last2, *first1, comp);
+            if (first2 == last2 || comp(*first1, *first2)) *out++ = *first1;
+            else ++first2;
+        }
+        return out;
+    } else { // 2 つ目の各要素を 1 つ目から探し、その間の部分をまとめて出力する
+        for (; first2 != last2; ++first2) {
+            RandomAccessIterator1 pos = detail::gallop(first1, last1, *first2, comp);
+            out = std::copy(first1, pos, out);
+            first1 = pos;
+            if (first1 != last1 && !comp(*first2, *first1)) ++first1;
+        }
+        return std::copy(first1, last1, out);
+    }
+}
+
+/**
+ * @brief ソート済みの 2 つの列の積集合を求めます。2 つの列の長さの比が gallop_ratio を超える場合は galloping_intersection を、
+ * そうでなく要素が std::uint32_t または std::uint64_t のポインタ範囲であれば simd_intersection を、いずれでもなければ std::set_intersection を利用します。
+ * 重複した値を含む場合も含め、いずれの方法でも結果は std::set_intersection と同じです
+ * @param first1 1 つ目の範囲の最初のイテレータ
+ * @param last1 1 つ目の範囲の最後 + 1 のイテレータ
+ * @param first2 2 つ目の範囲の最初のイテレータ
+ * @param last2 2 つ目の範囲の最後 + 1 のイテレータ
+ * @param out 出力イテレータ
+ * @param comp bool 値へ文脈変換可能な比較関数オブジェクト
+ * @return 出力イテレータを返します
+ * @code
+ * #include <vector>
+ * #include <numeric>
+ *
+ * void set_intersection_sample()
+ * {
+ *      std::vector<std::uint32_t> a(1000000), b { 4, 42, 999999, 2000000 }, res;
+ *      std::iota(std::begin(a), std::end(a), 0);
+ *      TPLCXX17::chap16_7_6::set_intersection(std::data(a), std::data(a) + a.size(), std::data(b), std::data(b) + b.size(), std::back_inserter(res)); // ギャロッピング
+ * }
+ * @endcode
+ */
+template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator, class Compare>
+OutputIterator set_intersection(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator2 first2, RandomAccessIterator2 last2, OutputIterator out, Compare comp)
+{
+    const std::size_t m = static_cast<std::size_t>(std::distance(first1, last1)), n = static_cast<std::size_t>(std::distance(first2, last2));
+    if (m * gallop_ratio < n) return galloping_intersection(first1, last1, first2, last2, out, comp);
+    if (n * gallop_ratio < m) return galloping_intersection(first2, last2, first1, last1, out, comp);
+    if constexpr (std::conjunction_v<std::is_same<RandomAccessIterator1, RandomAccessIterator2>, detail::is_simd_intersectable<RandomAccessIterator1, Compare>>) {
+        return simd_intersection(first1, last1, first2, last2, out);
+    } else {
+        return std::set_intersection(first1, last1, first2, last2, out, comp);
+    }
+}
+
+/**
+ * @brief ソート済みの 2 つの列の和集合を求めます。2 つの列の長さの比が gallop_ratio を超える場合は galloping_union を、そうでなければ std::set_union を利用します
+ * @param first1 1 つ目の範囲の最初のイテレータ
+ * @param last1 1 つ目の範囲の最後 + 1 のイテレータ
+ * @param first2 2 つ目の範囲の最初のイテレータ
+ * @param last2 2 つ目の範囲の最後 + 1 のイテレータ
+ * @param out 出力イテレータ
+ * @param comp bool 値へ文脈変換可能な比較関数オブジェクト
+ * @return 出力イテレータを返します
+ */
+template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator, class Compare>
+OutputIterator set_union(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator2 first2, RandomAccessIterator2 last2, OutputIterator out, Compare comp)
+{
+    const std::size_t m = static_cast<std::size_t>(std::distance(first1, last1)), n = static_cast<std::size_t>(std::distance(first2, last2));
+    if (m * gallop_ratio < n) return galloping_union(first1, last1, first2, last2, out, comp);
+    if (n * gallop_ratio < m) return galloping_union(first2, last2, first1, last1, out, comp);
+    return std::set_union(first1, last1, first2, last2, out, comp);
+}
+
+/**
+ * @brief ソート済みの 2 つの列の差集合 @p [first1, last1) - @p [first2, last2) を求めます。
+ * 2 つの列の長さの比が gallop_ratio を超える場合は galloping_difference を、そうでなければ std::set_difference を利用します
+ * @param first1 1 つ目の範囲の最初のイテレータ
+ * @param last1 1 つ目の範囲の最後 + 1 のイテレータ
+ * @param first2 2 つ目の範囲の最初のイテレータ
+ * @param last2 2 つ目の範囲の最後 + 1 のイテレータ
+ * @param out 出力イテレータ
+ * @param comp bool 値へ文脈変換可能な比較関数オブジェクト
+ * @return 出力イテレータを返します
+ */
+template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator, class Compare>
+OutputIterator set_difference(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator2 first2, RandomAccessIterator2 last2, OutputIterator out, Compare comp)
+{
+    const std::size_t m = static_cast<std::size_t>(std::distance(first1, last1)), n = static_cast<std::size_t>(std::distance(first2, last2));
+    if (m * gallop_ratio < n || n * gallop_ratio < m) return galloping_difference(first1, last1, first2, last2, out, comp);
+    return std::set_difference(first1, last1, first2, last2, out, comp);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <class InputIterator, class RandomAccessIterator, class OutputIterator>
+OutputIterator galloping_intersection(InputIterator first1, InputIterator last1, RandomAccessIterator first2, RandomAccessIterator last2, OutputIterator out)
+{
+    return chap16_7_6::galloping_intersection(first1, last1, first2, last2, out, std::less<>());
+}
+
+template <class InputIterator, class RandomAccessIterator, class OutputIterator>
+OutputIterator galloping_union(InputIterator first1, InputIterator last1, RandomAccessIterator first2, RandomAccessIterator last2, OutputIterator out)
+{
+    return chap16_7_6::galloping_union(first1, last1, first2, last2, out, std::less<>());
+}
+
+template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator>
+OutputIterator galloping_difference(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator2 first2, RandomAccessIterator2 last2, OutputIterator out)
+{
+    return chap16_7_6::galloping_difference(first1, last1, first2, last2, out, std::less<>());
+}
+
+template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator>
+OutputIterator set_intersection(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator2 first2, RandomAccessIterator2 last2, OutputIterator out)
+{
+    return chap16_7_6::set_intersection(first1, last1, first2, last2, out, std::less<>());
+}
+
+template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator>
+OutputIterator set_union(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator2 first2, RandomAccessIterator2 last2, OutputIterator out)
+{
+    return chap16_7_6::set_union(first1, last1, first2, last2, out, std::less<>());
+}
+
+template <class RandomAccessIterator1, class RandomAccessIterator2, class OutputIterator>
+OutputIterator set_difference(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator2 first2, RandomAccessIterator2 last2, OutputIterator out)
+{
+    return chap16_7_6::set_difference(first1, last1, first2, last2, out, std::less<>());
+}
+#endif
+
+} // namespace chap16_7_6
+} // namespace TPLCXX17
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace TPLCXX17 {
+//! chapter 16.7.7 namespace
+namespace chap16_7_7 {
+
+/**
+ * @class measurement
+ * @brief 一回の計測結果。ハードウェアパフォーマンスカウンタから得られなかった値は空となります
+ */
+struct measurement {
+    double ns = 0;                               //!< 実時間(ナノ秒)
+    std::optional<std::uint64_t> cycles;         //!< CPU サイクル数
+    std::optional<std::uint64_t> instructions;   //!< 実行された命令数
+    std::optional<std::uint64_t> cache_misses;   //!< 最終レベルキャッシュのミスの回数
+    std::optional<std::uint64_t> branch_misses;  //!< 分岐予測の失敗の回数
+};
+
+/**
+ * @class perf_counters
+ * @brief perf_event_open によるハードウェアパフォーマンスカウンタを用いて計測を行います。利用できない場合は実時間のみを計測します
+ * @code
+ * #include <vector>
+ * #include <numeric>
+ *
+ * void perf_counters_sample()
+ * {
+ *      std::vector<int> v(1000);
+ *      std::iota(std::begin(v), std::end(v), 0);
+ *      TPLCXX17::chap16_7_7::perf_counters pc;
+ *      TPLCXX17::chap16_7_7::measurement m = pc.measure([&v] { TPLCXX17::chap16_7_1::v1::binary_search(std::begin(v), std::end(v), 42); });
+ * }
+ * @endcode
+ */
+class perf_counters {
+public:
+    perf_counters()
+    {
+#if defined(__linux__)
+        constexpr std::uint64_t configs[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+        for (std::size_t i = 0; i < std::size(configs); ++i) {
+            perf_event_attr attr {};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof attr;
+            attr.config = configs[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1; // ユーザ空間の処理のみを数える
+            attr.exclude_hv = 1;
+            fds_[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)); // 失敗した場合は -1 となる
+        }
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    ~perf_counters()
+    {
+#if defined(__linux__)
+        for (int fd : fds_) if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    /**
+     * @brief ハードウェアパフォーマンスカウンタが一つでも利用できるかどうかを返します
+     * @return 利用できる場合 true
+     */
+    bool available() const noexcept
+    {
+        return std::any_of(std::begin(fds_), std::end(fds_), [](int fd) { return fd >= 0; });
+    }
+
+    /**
+     * @brief @a f を実行し、その間の各値を計測します
+     * @param f 計測対象の関数オブジェクト
+     * @return 計測結果
+     */
+    template <class F>
+    measurement measure(F&& f)
+    {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+        const auto start = std::chrono::steady_clock::now();
+        std::forward<F>(f)();
+        const auto stop = std::chrono::steady_clock::now();
+
+        measurement m;
+        m.ns = std::chrono::duration<double, std::nano>(stop - start).count();
+#if defined(__linux__)
+        std::optional<std::uint64_t>* const values[] = { &m.cycles, &m.instructions, &m.cache_misses, &m.branch_misses };
+        for (std::size_t i = 0; i < std::size(fds_); ++i) {
+            std::uint64_t v;
+            if (fds_[i] >= 0 && !::ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0) && ::read(fds_[i], &v, sizeof v) == sizeof v) *values[i] = v;
+        }
+#endif
+        return m;
+    }
+private:
+    int fds_[4] = { -1, -1, -1, -1 };
+};
+
+/**
+ * @brief 計測に用いる入力の分布
+ */
+enum class distribution { random, sorted, reversed, organ_pipe, few_unique, nearly_sorted };
+
+//! 全ての distribution
+inline constexpr distribution distributions[] = { 
+    distribution::random, distribution::sorted, distribution::reversed, distribution::organ_pipe, distribution::few_unique, distribution::nearly_sorted 
+};
+
+/**
+ * @brief distribution の名前を返します
+ * @param d 分布
+ * @return 名前
+ */
+constexpr const char* to_string(distribution d) noexcept
+{
+    switch (d) {
+    case distribution::random: return "random";
+    case distribution::sorted: return "sorted";
+    case distribution::reversed: return "reversed";
+    case distribution::organ_pipe: return "organ_pipe";
+    case distribution::few_unique: return "few_unique";
+    case distribution::nearly_sorted: return "nearly_sorted";
+    }
+    return "";
+}
+
+/**
+ * @brief 分布 @a d に従う長さ @a n の入力を生成します。同じ引数に対しては常に同じ入力を生成します
+ * @param d 分布
+ * @param n 長さ
+ * @param seed 乱数のシード値
+ * @return 生成した入力
+ */
+inline std::vector<int> make_input(distribution d, std::size_t n, std::uint32_t seed = 42)
+{
+    std::mt19937 mt(seed);
+    std::vector<int> v(n);
+    for (int& x : v) x = static_cast<int>(mt() >> 1);
+
+    switch (d) {
+    case distribution::random:
+        break;
+    case distribution::sorted:
+        std::sort(std::begin(v), std::end(v));
+        break;
+    case distribution::reversed:
+        std::sort(std::begin(v), std::end(v), std::greater<>());
+        break;
+    case distribution::organ_pipe:
+        std::sort(std::begin(v), std::next(std::begin(v), n / 2));
+        std::sort(std::next(std::begin(v), n / 2), std::end(v), std::greater<>());
+        break;
+    case distribution::few_unique:
+        for (int& x : v) x %= 8;
+        break;
+    case distribution::nearly_sorted: // ソート済みの列の 1% の要素をランダムに入れ替える
+        std::sort(std::begin(v), std::end(v));
+        for (std::size_t i = 0; n && i < n / 100; ++i) std::swap(v[mt() % n], v[mt() % n]);
+        break;
+    }
+    return v;
+}
+
+/**
+ * @class cache_level
+ * @brief 入力の大きさの目安とするキャッシュの階層
+ */
+struct cache_level {
+    const char* name;    //!< "L1", "L2", "L3", "DRAM" のいずれか
+    std::size_t bytes;   //!< その階層の容量。DRAM の場合は L3 の 4 倍とします
+};
+
+/**
+ * @brief 実行環境のデータキャッシュの容量を返します。取得できない場合は一般的な値を返します
+ * @return L1、L2、L3、DRAM の順の cache_level
+ */
+inline std::vector<cache_level> cache_levels()
+{
+    std::size_t l1 = 32 << 10, l2 = 1 << 20, l3 = 32 << 20;
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    const auto get = [](int name, std::size_t def) { const long r = ::sysconf(name); return r > 0 ? static_cast<std::size_t>(r) : def; };
+    l1 = get(_SC_LEVEL1_DCACHE_SIZE, l1);
+    l2 = get(_SC_LEVEL2_CACHE_SIZE, l2);
+    l3 = get(_SC_LEVEL3_CACHE_SIZE, l3);
+#endif
+    return { { "L1", l1 }, { "L2", l2 }, { "L3", l3 }, { "DRAM", l3 * 4 } };
+}
+
+/**
+ * @brief 計算結果を利用したものとみなさせ、計測対象の処理が最適化によって取り除かれることを防ぎます
+ * @param x 計算結果
+ * @return なし
+ */
+template <class T>
+inline void do_not_optimize(const T& x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(x) : "memory");
+#else
+    static const T* volatile sink;
+    sink = &x;
+#endif
+}
+
+} // namespace chap16_7_7
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+
+namespace chap = TPLCXX17::chap16_7_1;
+using namespace TPLCXX17::chap16_7_7;
+
+struct benchmark {
+    const char* name;
+    bool uses_distribution; // false の場合、入力の大きさ n だけを利用する
+    std::function<std::size_t(distribution)> max_n;
+    std::function<measurement(std::vector<int>&, perf_counters&)> run;
+};
+
+template <class Sort>
+benchmark sort_benchmark(const char* name, std::function<std::size_t(distribution)> max_n, Sort sort)
+{
+    return { name, true, std::move(max_n), [sort](std::vector<int>& v, perf_counters& pc) { 
+        return pc.measure([&] { sort(std::begin(v), std::end(v)); do_not_optimize(v.front()); }); 
+    } };
+}
+
+template <class Search>
+benchmark search_benchmark(const char* name, Search search)
+{
+    return { name, true, [](distribution) { return std::numeric_limits<std::size_t>::max(); }, [search](std::vector<int>& v, perf_counters& pc) {
+        std::vector<int> sorted = v; // 入力の各値を、それをソートした列から探索する
+        std::sort(std::begin(sorted), std::end(sorted));
+        return pc.measure([&] { for (int x : v) do_not_optimize(search(std::begin(sorted), std::end(sorted), x)); });
+    } };
+}
+
+std::vector<benchmark> benchmarks()
+{
+    constexpr std::size_t quadratic = 1 << 14, unlimited = std::numeric_limits<std::size_t>::max();
+    const auto always = [](std::size_t n) { return [n](distribution) { return n; }; };
+    
+    return {
+        { "v1::sum", false, always(unlimited), [](std::vector<int>& v, perf_counters& pc) { 
+            return pc.measure([&] { do_not_optimize(chap::v1::sum(static_cast<unsigned int>(v.size()))); }); } },
+        { "v2::sum", false, always(unlimited), [](std::vector<int>& v, perf_counters& pc) { 
+            return pc.measure([&] { do_not_optimize(chap::v2::sum(static_cast<unsigned int>(v.size()))); }); } },
+        { "v1::primes", false, always(1 << 20), [](std::vector<int>& v, perf_counters& pc) {
+            std::vector<unsigned int> r;
+            return pc.measure([&] { chap::v1::primes(static_cast<unsigned int>(v.size()), std::back_inserter(r)); do_not_optimize(r.size()); }); } },
+        { "v2::primes", false, always(unlimited), [](std::vector<int>& v, perf_counters& pc) {
+            std::vector<unsigned int> r;
+            return pc.measure([&] { chap::v2::primes(static_cast<unsigned int>(v.size()), std::back_inserter(r)); do_not_optimize(r.size()); }); } },
+        sort_benchmark("v1::selection_sort", always(quadratic), [](auto f, auto l) { chap::v1::selection_sort(f, l); }),
+        sort_benchmark("v1::bubble_sort", always(quadratic), [](auto f, auto l) { chap::v1::bubble_sort(f, l); }),
+        sort_benchmark("v1::insertion_sort", always(quadratic), [](auto f, auto l) { chap::v1::insertion_sort(f, l); }),
+        sort_benchmark("v1::insertion_sort(v2::search_insert)", always(quadratic), [](auto f, auto l) { chap::v1::insertion_sort(f, l, std::less<>(), chap::v2::search_insert()); }),
+        sort_benchmark("v1::merge_sort", always(unlimited), [](auto f, auto l) { chap::v1::merge_sort(f, l); }),
+        sort_benchmark("v1::quick_sort", [=](distribution d) { return d == distribution::random ? unlimited : quadratic; }, [](auto f, auto l) { chap::v1::quick_sort(f, l); }),
+        sort_benchmark("v2::quick_sort", [=](distribution d) { return d == distribution::sorted || d == distribution::random || d == distribution::nearly_sorted ? unlimited : quadratic; }, 
+            [](auto f, auto l) { chap::v2::quick_sort(f, l, std::less<>()); }),
+        search_benchmark("v1::lower_bound", [](auto f, auto l, int x) { return chap::v1::lower_bound(f, l, x); }),
+        search_benchmark("v1::binary_search", [](auto f, auto l, int x) { return chap::v1::binary_search(f, l, x); }),
+    };
+}
+
+template <class T>
+std::string value(const std::optional<T>& x, const char* none)
+{
+    return x ? std::to_string(*x) : none;
+}
+
+int main(int argc, char** argv)
+{
+    const bool json = argc > 1 && !std::strcmp(argv[1], "--json");
+    perf_counters pc;
+    if (!pc.available()) std::cerr << "hardware performance counters are not available; measuring wall time only" << std::endl;
+
+    if (!json) std::cout << "algorithm,distribution,n,level,ns,cycles,instructions,cache_misses,branch_misses" << std::endl;
+    for (const benchmark& b : benchmarks()) {
+        for (const cache_level& level : cache_levels()) {
+            const std::size_t n = level.name == std::string("DRAM") ? level.bytes / sizeof(int) : level.bytes / 2 / sizeof(int); // キャッシュの半分程度を使う
+            for (distribution d : distributions) {
+                if (n > b.max_n(d)) continue;
+                
+                measurement best;
+                best.ns = std::numeric_limits<double>::infinity();
+                for (int i = 0; i < 3; ++i) {
+                    std::vector<int> v = b.uses_distribution ? make_input(d, n) : std::vector<int>(n);
+                    measurement m = b.run(v, pc);
+                    if (m.ns < best.ns) best = m;
+                }
+
+                const char* dname = b.uses_distribution ? to_string(d) : "-";
+                if (json) {
+                    std::cout << "{\"algorithm\":\"" << b.name << "\",\"distribution\":\"" << dname << "\",\"n\":" << n << ",\"level\":\"" << level.name 
+                        << "\",\"ns\":" << static_cast<std::uint64_t>(best.ns) << ",\"cycles\":" << value(best.cycles, "null") << ",\"instructions\":" << value(best.instructions, "null") 
+                        << ",\"cache_misses\":" << value(best.cache_misses, "null") << ",\"branch_misses\":" << value(best.branch_misses, "null") << "}" << std::endl;
+                } else {
+                    std::cout << b.name << ',' << dname << ',' << n << ',' << level.name << ',' << static_cast<std::uint64_t>(best.ns) << ',' << value(best.cycles, "") << ',' 
+                        << value(best.instructions, "") << ',' << value(best.cache_misses, "") << ',' << value(best.branch_misses, "") << std::endl;
+                }
+                if (!b.uses_distribution) break; // 分布を利用しないものは一度だけ計測する
+            }
+        }
+    }
+}
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+namespace TPLCXX17 {
+//! chapter 16.7.8 namespace
+namespace chap16_7_8 {
+
+/**
+ * @class op_counts
+ * @brief 操作の種類ごとの回数
+ */
+struct op_counts {
+    std::uint64_t compares = 0;  //!< 比較
+    std::uint64_t swaps = 0;     //!< 交換
+    std::uint64_t moves = 0;     //!< ムーブ構築、ムーブ代入
+    std::uint64_t copies = 0;    //!< コピー構築、コピー代入
+    std::uint64_t advances = 0;  //!< イテレータを進める、または戻す操作
+
+    /**
+     * @brief 全ての操作の回数の合計を返します
+     * @return 合計
+     */
+    constexpr std::uint64_t total() const noexcept { return compares + swaps + moves + copies + advances; }
+};
+
+//! 現在のスレッドで数えた操作の回数。計測の前に op_counts{} を代入してリセットします
+inline thread_local op_counts operation_counts;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#ifdef TPLCXX17_COUNT_OPERATIONS
+#   define TPLCXX17_COUNT_OP(member) static_cast<void>(++::TPLCXX17::chap16_7_8::operation_counts.member)
+#else
+#   define TPLCXX17_COUNT_OP(member) static_cast<void>(0)
+#endif
+#endif
+
+/**
+ * @class counted
+ * @brief 比較(operator<)、交換(swap)、ムーブ、コピーの回数を数える値の型
+ * @code
+ * void counted_sample()
+ * {
+ *      std::vector<TPLCXX17::chap16_7_8::counted<int>> v { 3, 1, 4, 1, 5 };
+ *      TPLCXX17::chap16_7_8::operation_counts = {};
+ *      TPLCXX17::chap16_7_1::v1::selection_sort(std::begin(v), std::end(v));
+ *      [[maybe_unused]] auto c = TPLCXX17::chap16_7_8::operation_counts.compares;
+ * }
+ * @endcode
+ */
+template <class T>
+class counted {
+public:
+    counted() = default;
+    /**
+     * @brief 元の値から構築します。この構築は数えません
+     * @param x 元の値
+     */
+    counted(T x) : value_(std::move(x)) {}
+    counted(const counted& other) : value_(other.value_) { TPLCXX17_COUNT_OP(copies); }
+    counted(counted&& other) noexcept : value_(std::move(other.value_)) { TPLCXX17_COUNT_OP(moves); }
+
+    counted& operator=(const counted& other)
+    {
+        TPLCXX17_COUNT_OP(copies);
+        value_ = other.value_;
+        return *this;
+    }
+
+    counted& operator=(counted&& other) noexcept
+    {
+        TPLCXX17_COUNT_OP(moves);
+        value_ = std::move(other.value_);
+        return *this;
+    }
+
+    /**
+     * @brief 元の値を返します
+     * @return 元の値
+     */
+    const T& get() const noexcept { return value_; }
+private:
+    friend bool operator<(const counted& x, const counted& y)
+    {
+        TPLCXX17_COUNT_OP(compares);
+        return x.value_ < y.value_;
+    }
+
+    friend bool operator==(const counted& x, const counted& y)
+    {
+        TPLCXX17_COUNT_OP(compares);
+        return x.value_ == y.value_;
+    }
+
+    friend void swap(counted& x, counted& y) noexcept
+    {
+        TPLCXX17_COUNT_OP(swaps);
+        using std::swap;
+        swap(x.value_, y.value_);
+    }
+
+    T value_ {};
+};
+
+/**
+ * @class counting_comparator
+ * @brief 比較の回数を数える比較関数オブジェクト
+ */
+template <class Compare>
+struct counting_comparator {
+    Compare comp;
+
+    template <class T, class U>
+    bool operator()(T&& x, U&& y)
+    {
+        TPLCXX17_COUNT_OP(compares);
+        return comp(std::forward<T>(x), std::forward<U>(y));
+    }
+};
+
+/**
+ * @class counting_iterator
+ * @brief ランダムアクセスイテレータ @a Iterator を包み、進める(戻す)操作の回数を数えます
+ */
+template <class Iterator>
+class counting_iterator {
+    typedef std::iterator_traits<Iterator> traits_type;
+public:
+    typedef typename traits_type::iterator_category iterator_category;
+    typedef typename traits_type::value_type value_type;
+    typedef typename traits_type::difference_type difference_type;
+    typedef typename traits_type::pointer pointer;
+    typedef typename traits_type::reference reference;
+
+    counting_iterator() = default;
+    /**
+     * @param iter 包むイテレータ
+     */
+    explicit counting_iterator(Iterator iter) : iter_(std::move(iter)) {}
+
+    /**
+     * @brief 包んでいるイテレータを返します
+     * @return 包んでいるイテレータ
+     */
+    Iterator base() const { return iter_; }
+
+    reference operator*() const { return *iter_; }
+    pointer operator->() const { return std::addressof(*iter_); }
+    reference operator[](difference_type n) const { return iter_[n]; }
+
+    counting_iterator& operator++() { TPLCXX17_COUNT_OP(advances); ++iter_; return *this; }
+    counting_iterator& operator--() { TPLCXX17_COUNT_OP(advances); --iter_; return *this; }
+    counting_iterator operator++(int) { counting_iterator r = *this; ++*this; return r; }
+    counting_iterator operator--(int) { counting_iterator r = *this; --*this; return r; }
+    counting_iterator& operator+=(difference_type n) { TPLCXX17_COUNT_OP(advances); iter_ += n; return *this; }
+    counting_iterator& operator-=(difference_type n) { TPLCXX17_COUNT_OP(advances); iter_ -= n; return *this; }
+private:
+    friend counting_iterator operator+(counting_iterator x, difference_type n) { return x += n; }
+    friend counting_iterator operator+(difference_type n, counting_iterator x) { return x += n; }
+    friend counting_iterator operator-(counting_iterator x, difference_type n) { return x -= n; }
+    friend difference_type operator-(const counting_iterator& x, const counting_iterator& y) { return x.iter_ - y.iter_; }
+    friend bool operator==(const counting_iterator& x, const counting_iterator& y) { return x.iter_ == y.iter_; }
+    friend bool operator!=(const counting_iterator& x, const counting_iterator& y) { return x.iter_ != y.iter_; }
+    friend bool operator<(const counting_iterator& x, const counting_iterator& y) { return x.iter_ < y.iter_; }
+    friend bool operator>(const counting_iterator& x, const counting_iterator& y) { return x.iter_ > y.iter_; }
+    friend bool operator<=(const counting_iterator& x, const counting_iterator& y) { return x.iter_ <= y.iter_; }
+    friend bool operator>=(const counting_iterator& x, const counting_iterator& y) { return x.iter_ >= y.iter_; }
+
+    Iterator iter_ {};
+};
+
+} // namespace chap16_7_8
+} // namespace TPLCXX17
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace TPLCXX17 {
+namespace chap16_7_8 {
+
+/**
+ * @brief 計算量オーダー
+ */
+enum class complexity { log_n, n, n_log_n, n_squared };
+
+/**
+ * @brief complexity の名前を返します
+ * @param c 計算量オーダー
+ * @return 名前
+ */
+constexpr const char* to_string(complexity c) noexcept
+{
+    switch (c) {
+    case complexity::log_n: return "O(logN)";
+    case complexity::n: return "O(N)";
+    case complexity::n_log_n: return "O(NlogN)";
+    case complexity::n_squared: return "O(N^2)";
+    }
+    return "";
+}
+
+/**
+ * @brief 計算量オーダー @a c の関数の値を返します
+ * @param c 計算量オーダー
+ * @param n 入力の大きさ
+ * @return @a c の関数の @a n における値
+ */
+inline double evaluate(complexity c, double n) noexcept
+{
+    switch (c) {
+    case complexity::log_n: return std::log2(n);
+    case complexity::n: return n;
+    case complexity::n_log_n: return n * std::log2(n);
+    case complexity::n_squared: return n * n;
+    }
+    return 0;
+}
+
+/**
+ * @class sample
+ * @brief 入力の大きさと、そのときの操作の回数の組
+ */
+struct sample {
+    std::size_t n;  //!< 入力の大きさ
+    double ops;     //!< 操作の回数
+};
+
+/**
+ * @class fit_result
+ * @brief fit の結果
+ */
+struct fit_result {
+    complexity order;    //!< 推定した計算量オーダー
+    double coefficient;  //!< 係数
+    double residual;     //!< 相対誤差の二乗和
+
+    /**
+     * @brief 推定した計算量オーダーから、入力の大きさ @a n における操作の回数を予測します
+     * @param n 入力の大きさ
+     * @return 予測した操作の回数
+     */
+    double predict(std::size_t n) const noexcept { return coefficient * evaluate(order, static_cast<double>(n)); }
+};
+
+/**
+ * @brief @a samples に最も近い計算量オーダーを推定します
+ * @param samples 入力の大きさと操作の回数の組の列。操作の回数は正である必要があります
+ * @return 推定結果
+ */
+inline fit_result fit(const std::vector<sample>& samples)
+{
+    fit_result best { complexity::n, 0, std::numeric_limits<double>::infinity() };
+    for (complexity c : { complexity::log_n, complexity::n, complexity::n_log_n, complexity::n_squared }) {
+        double sfc = 0, sff = 0; // a = Σ(f/c) / Σ(f/c)^2 のとき相対誤差の二乗和が最小となる
+        for (const sample& s : samples) {
+            const double r = evaluate(c, static_cast<double>(s.n)) / s.ops;
+            sfc += r;
+            sff += r * r;
+        }
+        const double a = sff > 0 ? sfc / sff : 0;
+
+        double residual = 0;
+        for (const sample& s : samples) {
+            const double e = 1 - a * evaluate(c, static_cast<double>(s.n)) / s.ops;
+            residual += e * e;
+        }
+        if (residual < best.residual) best = { c, a, residual };
+    }
+    return best;
+}
+
+} // namespace chap16_7_8
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace chap = TPLCXX17::chap16_7_1;
+using namespace TPLCXX17::chap16_7_8;
+using TPLCXX17::chap16_7_7::distribution;
+
+typedef std::vector<counted<int>> container;
+typedef counting_iterator<container::iterator> iterator;
+
+struct target {
+    const char* name;
+    complexity expected;
+    std::size_t min_n, max_n;
+    std::function<op_counts(std::size_t, distribution)> run;
+};
+
+template <class Sort>
+target sort_target(const char* name, complexity expected, Sort sort)
+{
+    return { name, expected, 1 << 8, 1 << 13, [sort](std::size_t n, distribution d) {
+        const std::vector<int> input = TPLCXX17::chap16_7_7::make_input(d, n);
+        container v(std::begin(input), std::end(input));
+        operation_counts = {};
+        sort(iterator(std::begin(v)), iterator(std::end(v)));
+        return operation_counts;
+    } };
+}
+
+template <class Search>
+target search_target(const char* name, Search search)
+{
+    return { name, complexity::log_n, 1 << 10, 1 << 20, [search](std::size_t n, distribution d) {
+        std::vector<int> input = TPLCXX17::chap16_7_7::make_input(d, n);
+        const std::vector<int> queries(std::begin(input), std::next(std::begin(input), 1000)); // 1000 回の探索の平均を取る
+        std::sort(std::begin(input), std::end(input));
+        container v(std::begin(input), std::end(input));
+
+        operation_counts = {};
+        for (int q : queries) search(iterator(std::begin(v)), iterator(std::end(v)), counted<int>(q));
+        op_counts c = operation_counts;
+        for (std::uint64_t* x : { &c.compares, &c.swaps, &c.moves, &c.copies, &c.advances }) *x /= queries.size();
+        return c;
+    } };
+}
+
+int main()
+{
+#ifndef TPLCXX17_COUNT_OPERATIONS
+    std::cerr << "compile with -DTPLCXX17_COUNT_OPERATIONS" << std::endl;
+    return 1;
+#endif
+    constexpr std::size_t large = 1 << 20;
+    constexpr double budget = 1e10;
+
+    const target targets[] = {
+        sort_target("v1::selection_sort", complexity::n_squared, [](auto f, auto l) { chap::v1::selection_sort(f, l); }),
+        sort_target("v1::bubble_sort", complexity::n_squared, [](auto f, auto l) { chap::v1::bubble_sort(f, l); }),
+        sort_target("v1::insertion_sort", complexity::n_squared, [](auto f, auto l) { chap::v1::insertion_sort(f, l); }),
+        sort_target("v1::merge_sort", complexity::n_log_n, [](auto f, auto l) { chap::v1::merge_sort(f, l); }),
+        sort_target("v1::quick_sort", complexity::n_log_n, [](auto f, auto l) { chap::v1::quick_sort(f, l); }),
+        sort_target("v2::quick_sort", complexity::n_log_n, [](auto f, auto l) { chap::v2::quick_sort(f, l, std::less<>()); }),
+        search_target("v1::lower_bound", [](auto f, auto l, const auto& x) { return chap::v1::lower_bound(f, l, x); }),
+        search_target("v1::binary_search", [](auto f, auto l, const auto& x) { return chap::v1::binary_search(f, l, x); }),
+    };
+
+    int status = 0;
+    for (const target& t : targets) {
+        for (distribution d : { distribution::random, distribution::sorted }) {
+            std::vector<sample> samples;
+            op_counts last;
+            for (std::size_t n = t.min_n; n <= t.max_n; n *= 2) {
+                last = t.run(n, d);
+                samples.push_back({ n, static_cast<double>(last.total()) + 1 }); // 0 回の場合に備えて 1 を加える
+            }
+            const fit_result r = fit(samples);
+
+            std::cout << t.name << " (" << to_string(d) << "): " << to_string(r.order) << " (expected " << to_string(t.expected) << ")"
+                << ", at n = " << samples.back().n << ": compares " << last.compares << ", swaps " << last.swaps << ", moves " << last.moves 
+                << ", copies " << last.copies << ", advances " << last.advances;
+            if (r.order > t.expected) {
+                std::cout << " REGRESSION";
+                status = 1;
+            }
+            if (r.predict(large) > budget) std::cout << " TOO SLOW (predicted " << r.predict(large) << " operations at n = " << large << ")";
+            std::cout << std::endl;
+        }
+    }
+    return status;
+}
+#endif
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace TPLCXX17 {
+//! chapter 16.7.9 namespace
+namespace chap16_7_9 {
+
+/**
+ * @class thread_pool
+ * @brief 予め生成したスレッドで、渡された処理を実行します
+ * @code
+ * void thread_pool_sample()
+ * {
+ *      TPLCXX17::chap16_7_9::thread_pool pool(4);
+ *      std::future<int> f = pool.submit([] { return 42; });
+ *      [[maybe_unused]] int r = f.get();
+ * }
+ * @endcode
+ */
+class thread_pool {
+public:
+    /**
+     * @param n スレッドの数
+     */
+    explicit thread_pool(std::size_t n = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        workers_.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) workers_.emplace_back([this] { run(); });
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /**
+     * @brief 既に渡された処理を全て実行し終えてから、スレッドを終了します
+     */
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        for (std::thread& w : workers_) w.join();
+    }
+
+    /**
+     * @brief スレッドの数を返します
+     * @return スレッドの数
+     */
+    std::size_t size() const noexcept { return workers_.size(); }
+
+    /**
+     * @brief 処理 @a f をいずれかのスレッドで実行します
+     * @param f 処理
+     * @return @a f の結果を受け取る std::future
+     */
+    template <class F>
+    std::future<std::invoke_result_t<F>> submit(F f)
+    {
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::move(f));
+        std::future<std::invoke_result_t<F>> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) throw std::runtime_error(__func__ + std::string(": the pool has been stopped"));
+            tasks_.emplace([task] { (*task)(); });
+        }
+        cond_.notify_one();
+        return result;
+    }
+
+    /**
+     * @brief ハードウェアのスレッド数と同じ数のスレッドを持つ、共有のスレッドプールを返します
+     * @return 共有のスレッドプール
+     */
+    static thread_pool& instance()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+private:
+    void run()
+    {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (stop_ && tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_ = false;
+};
+
+/**
+ * @brief [ @a first, @a last ) を @a pool のスレッドの数だけの区間に分け、各区間に @a f を適用した結果を順に返します
+ * @param pool スレッドプール
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param f 区間の先頭と終端へのポインタを受け取る関数
+ * @return 各区間に @a f を適用した結果の列
+ * @note 区間の境界は 64 バイト単位となるように揃えます。最後の区間は呼び出し元のスレッドで処理します
+ */
+template <class T, class F>
+std::vector<std::invoke_result_t<F&, const T*, const T*>> parallel_chunks(thread_pool& pool, const T* first, const T* last, F f)
+{
+    typedef std::invoke_result_t<F&, const T*, const T*> result_type;
+    constexpr std::size_t align = std::max<std::size_t>(1, 64 / sizeof(T));
+
+    const std::size_t n = static_cast<std::size_t>(last - first), chunks = std::max<std::size_t>(1, pool.size());
+    const std::size_t chunk = (n / chunks + align - 1) / align * align;
+
+    std::vector<std::future<result_type>> futures;
+    const T* p = first;
+    for (std::size_t i = 0; i + 1 < chunks && static_cast<std::size_t>(last - p) > chunk; ++i, p += chunk) {
+        futures.push_back(pool.submit([&f, p, chunk] { return f(p, p + chunk); }));
+    }
+    result_type tail = f(p, last);
+
+    std::vector<result_type> results;
+    results.reserve(futures.size() + 1);
+    for (std::future<result_type>& r : futures) results.push_back(r.get());
+    results.push_back(std::move(tail));
+    return results;
+}
+
+} // namespace chap16_7_9
+} // namespace TPLCXX17
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace TPLCXX17 {
+namespace chap16_7_9 {
+
+//! これより要素の数が少ない場合、スレッドに分けずに処理します
+constexpr std::size_t parallel_threshold = 1 << 18;
+
+/**
+ * @brief 要素の型 @a T の総和を溢れることなく足し合わせるための型
+ */
+template <class T>
+struct accumulator {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "T must be an arithmetic type");
+#ifdef __SIZEOF_INT128__
+    typedef std::conditional_t<std::is_signed_v<T>, __int128, unsigned __int128> wide_type;
+#else
+    typedef std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t> wide_type;
+#endif
+    typedef std::conditional_t<
+        std::is_floating_point_v<T>,
+        std::conditional_t<(sizeof(T) < sizeof(double)), double, T>,
+        std::conditional_t<(sizeof(T) < sizeof(std::int64_t)), std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>, wide_type>
+    > type;
+};
+
+//! accumulator の略記
+template <class T>
+using accumulator_t = typename accumulator<T>::type;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+template <class Acc, class T, class BinaryOperation>
+Acc reduce_serial(const T* first, const T* last, BinaryOperation op)
+{
+    // 4 つの変数に分けて、加算の依存関係の連鎖を断つ。[ first, last ) は空でない
+    if (last - first < 4) {
+        Acc r = static_cast<Acc>(*first);
+        for (++first; first != last; ++first) r = op(r, static_cast<Acc>(*first));
+        return r;
+    }
+    Acc a0 = static_cast<Acc>(first[0]), a1 = static_cast<Acc>(first[1]), a2 = static_cast<Acc>(first[2]), a3 = static_cast<Acc>(first[3]);
+    for (first += 4; last - first >= 4; first += 4) {
+        a0 = op(a0, static_cast<Acc>(first[0]));
+        a1 = op(a1, static_cast<Acc>(first[1]));
+        a2 = op(a2, static_cast<Acc>(first[2]));
+        a3 = op(a3, static_cast<Acc>(first[3]));
+    }
+    for (; first != last; ++first) a0 = op(a0, static_cast<Acc>(*first));
+    return op(op(a0, a1), op(a2, a3));
+}
+
+#if defined(__SSE2__)
+template <class T>
+accumulator_t<T> sum_simd(const T* first, const T* last)
+{
+    accumulator_t<T> r = 0;
+    if constexpr (std::is_integral_v<T>) {
+        // 4 つの 32 ビット整数を 64 ビットに広げ、2 要素ずつ 4 つのレジスタに足し合わせる
+        const __m128i zero = _mm_setzero_si128();
+        __m128i a0 = zero, a1 = zero, a2 = zero, a3 = zero;
+        for (; last - first >= 8; first += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 4));
+            const __m128i sv = std::is_signed_v<T> ? _mm_srai_epi32(v, 31) : zero; // 上位 32 ビット(符号拡張)
+            const __m128i sw = std::is_signed_v<T> ? _mm_srai_epi32(w, 31) : zero;
+            a0 = _mm_add_epi64(a0, _mm_unpacklo_epi32(v, sv));
+            a1 = _mm_add_epi64(a1, _mm_unpackhi_epi32(v, sv));
+            a2 = _mm_add_epi64(a2, _mm_unpacklo_epi32(w, sw));
+            a3 = _mm_add_epi64(a3, _mm_unpackhi_epi32(w, sw));
+        }
+        alignas(16) accumulator_t<T> lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(_mm_add_epi64(a0, a1), _mm_add_epi64(a2, a3)));
+        r = lanes[0] + lanes[1];
+    } else {
+        __m128d a0 = _mm_setzero_pd(), a1 = a0, a2 = a0, a3 = a0;
+        if constexpr (std::is_same_v<T, float>) {
+            // 4 つの float を 2 つずつ double に広げる
+            for (; last - first >= 8; first += 8) {
+                const __m128 v = _mm_loadu_ps(first), w = _mm_loadu_ps(first + 4);
+                a0 = _mm_add_pd(a0, _mm_cvtps_pd(v));
+                a1 = _mm_add_pd(a1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+                a2 = _mm_add_pd(a2, _mm_cvtps_pd(w));
+                a3 = _mm_add_pd(a3, _mm_cvtps_pd(_mm_movehl_ps(w, w)));
+            }
+        } else {
+            for (; last - first >= 8; first += 8) {
+                a0 = _mm_add_pd(a0, _mm_loadu_pd(first));
+                a1 = _mm_add_pd(a1, _mm_loadu_pd(first + 2));
+                a2 = _mm_add_pd(a2, _mm_loadu_pd(first + 4));
+                a3 = _mm_add_pd(a3, _mm_loadu_pd(first + 6));
+            }
+        }
+        alignas(16) double lanes[2];
+        _mm_store_pd(lanes, _mm_add_pd(_mm_add_pd(a0, a1), _mm_add_pd(a2, a3)));
+        r = lanes[0] + lanes[1];
+    }
+    for (; first != last; ++first) r += *first;
+    return r;
+}
+
+template <class T>
+struct is_simd_summable
+    : std::bool_constant<
+        (std::is_integral_v<T> && sizeof(T) == sizeof(std::int32_t)) || std::is_same_v<T, float> || std::is_same_v<T, double>
+    > {};
+#endif
+
+template <class T>
+accumulator_t<T> sum_serial(const T* first, const T* last)
+{
+#if defined(__SSE2__)
+    if constexpr (is_simd_summable<T>::value) return sum_simd(first, last);
+#endif
+    return first == last ? accumulator_t<T>(0) : reduce_serial<accumulator_t<T>>(first, last, std::plus<>());
+}
+
+} // namespace detail
+#endif
+
+/**
+ * @brief [ @a first, @a last ) を二項演算 @a op で畳み込みます
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param init 初期値
+ * @param op 結合則と交換則を満たす二項演算
+ * @param pool 要素の数が parallel_threshold 以上の場合に用いるスレッドプール
+ * @return 畳み込んだ結果
+ * @note 要素は型 @a Acc に変換してから @a op に渡します。要素を足し合わせる順序は定まっていません
+ * @code
+ * void reduce_sample()
+ * {
+ *      const std::vector<int> v { 3, 1, 4, 1, 5 };
+ *      [[maybe_unused]] int r = TPLCXX17::chap16_7_9::reduce(v.data(), v.data() + v.size(), 0, [](int x, int y) { return std::max(x, y); });
+ * }
+ * @endcode
+ */
+template <class T, class Acc, class BinaryOperation>
+Acc reduce(const T* first, const T* last, Acc init, BinaryOperation op, thread_pool& pool = thread_pool::instance())
+{
+    if (first == last) return init;
+    auto chunk = [&op](const T* f, const T* l) { return detail::reduce_serial<Acc>(f, l, op); };
+    if (static_cast<std::size_t>(last - first) < parallel_threshold || pool.size() < 2) return op(init, chunk(first, last));
+
+    const std::vector<Acc> partial = parallel_chunks(pool, first, last, chunk);
+    return std::accumulate(std::begin(partial), std::end(partial), init, op);
+}
+
+/**
+ * @brief [ @a first, @a last ) の総和を求めます
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param pool 要素の数が parallel_threshold 以上の場合に用いるスレッドプール
+ * @return 総和。要素の型より広い accumulator_t<T> 型で返します
+ * @code
+ * void sum_sample()
+ * {
+ *      const std::vector<int> v(1 << 20, std::numeric_limits<int>::max());
+ *      [[maybe_unused]] std::int64_t r = TPLCXX17::chap16_7_9::sum(v.data(), v.data() + v.size());
+ * }
+ * @endcode
+ */
+template <class T>
+accumulator_t<T> sum(const T* first, const T* last, thread_pool& pool = thread_pool::instance())
+{
+    if (static_cast<std::size_t>(last - first) < parallel_threshold || pool.size() < 2) return detail::sum_serial(first, last);
+
+    const std::vector<accumulator_t<T>> partial = parallel_chunks(pool, first, last, [](const T* f, const T* l) { return detail::sum_serial(f, l); });
+    return std::accumulate(std::begin(partial), std::end(partial), accumulator_t<T>(0));
+}
+
+} // namespace chap16_7_9
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+
+template <class F>
+double best_seconds(F f)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < 5; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+template <class T>
+void run(const char* type, std::size_t n)
+{
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> dist(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+    std::vector<T> v(n);
+    for (T& x : v) x = static_cast<T>(dist(engine));
+
+    const double bytes = static_cast<double>(n * sizeof(T));
+    auto report = [&](const char* name, auto f) {
+        decltype(f()) r {};
+        const double s = best_seconds([&] { r = f(); });
+        std::cout << type << " " << name << ": " << bytes / s * 1e-9 << " GB/s, result = " << static_cast<long double>(r) << std::endl;
+    };
+
+    TPLCXX17::chap16_7_9::thread_pool single(1);
+    report("std::accumulate", [&] { return std::accumulate(std::begin(v), std::end(v), TPLCXX17::chap16_7_9::accumulator_t<T>(0)); });
+    report("sum (1 thread)", [&] { return TPLCXX17::chap16_7_9::sum(v.data(), v.data() + v.size(), single); });
+    report("sum", [&] { return TPLCXX17::chap16_7_9::sum(v.data(), v.data() + v.size()); });
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(1) << 26;
+    std::cout << "threads: " << TPLCXX17::chap16_7_9::thread_pool::instance().size() << std::endl;
+    run<std::int32_t>("int32", n);
+    run<float>("float", n);
+    run<double>("double", n);
+}
+#endif
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace TPLCXX17 {
+//! chapter 16.7.10 namespace
+namespace chap16_7_10 {
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+// [ first, last ) の累積和を carry から始めて d_first に書き込み、最後の和を返す。first と d_first は同じでも良い
+template <bool Exclusive, class T>
+T scan_serial(const T* first, const T* last, T* d_first, T carry) noexcept
+{
+#if defined(__SSE2__)
+    if constexpr (std::is_integral_v<T> && sizeof(T) == sizeof(std::int32_t)) {
+        __m128i c = _mm_set1_epi32(static_cast<std::int32_t>(carry));
+        for (; last - first >= 4; first += 4, d_first += 4) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+            x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+            const __m128i r = _mm_add_epi32(Exclusive ? _mm_slli_si128(x, 4) : x, c);
+            c = _mm_add_epi32(c, _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d_first), r);
+        }
+        carry = static_cast<T>(_mm_cvtsi128_si32(c));
+    } else if constexpr (std::is_same_v<T, float>) {
+        __m128 c = _mm_set1_ps(carry);
+        for (; last - first >= 4; first += 4, d_first += 4) {
+            __m128 x = _mm_loadu_ps(first);
+            x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+            x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+            const __m128 r = _mm_add_ps(Exclusive ? _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)) : x, c);
+            c = _mm_add_ps(c, _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3)));
+            _mm_storeu_ps(d_first, r);
+        }
+        carry = _mm_cvtss_f32(c);
+    } else if constexpr (std::is_same_v<T, double>) {
+        __m128d c = _mm_set1_pd(carry);
+        for (; last - first >= 2; first += 2, d_first += 2) {
+            __m128d x = _mm_loadu_pd(first);
+            x = _mm_add_pd(x, _mm_castsi128_pd(_mm_slli_si128(_mm_castpd_si128(x), 8)));
+            const __m128d r = _mm_add_pd(Exclusive ? _mm_castsi128_pd(_mm_slli_si128(_mm_castpd_si128(x), 8)) : x, c);
+            c = _mm_add_pd(c, _mm_unpackhi_pd(x, x));
+            _mm_storeu_pd(d_first, r);
+        }
+        carry = _mm_cvtsd_f64(c);
+    }
+#endif
+    for (; first != last; ++first, ++d_first) {
+        const T x = *first;
+        if constexpr (Exclusive) {
+            *d_first = carry;
+            carry += x;
+        } else {
+            *d_first = carry += x;
+        }
+    }
+    return carry;
+}
+
+// 真の値は sum + error に近い
+// float の場合、補正項自体にも float の丸め誤差が蓄積するため、和と補正項を double で持つ
+template <class T>
+struct compensated {
+    typedef std::conditional_t<(sizeof(T) < sizeof(double)), double, T> value_type;
+    value_type sum, error;
+
+    void add(value_type x) noexcept
+    {
+        const value_type t = sum + x;
+        error += std::fabs(sum) >= std::fabs(x) ? (sum - t) + x : (x - t) + sum;
+        sum = t;
+    }
+};
+
+template <class T>
+compensated<T> compensated_scan_serial(const T* first, const T* last, T* d_first, compensated<T> carry) noexcept
+{
+    for (; first != last; ++first, ++d_first) {
+        carry.add(*first);
+        *d_first = static_cast<T>(carry.sum + carry.error);
+    }
+    return carry;
+}
+
+template <class T, class Total, class Carry, class Scan>
+void block_scan(const T* first, const T* last, T* d_first, Carry init, chap16_7_9::thread_pool& pool, Total total, Scan scan)
+{
+    // 一度目: 各区間の総和を求める
+    const auto totals = chap16_7_9::parallel_chunks(pool, first, last, [&total](const T* f, const T* l) { return std::make_pair(f, total(f, l)); });
+
+    std::vector<const T*> starts;
+    std::vector<Carry> offsets;
+    for (const auto& t : totals) {
+        starts.push_back(t.first);
+        offsets.push_back(init);
+        init = init + t.second;
+    }
+
+    // 二度目: 各区間の開始時点での和から累積和を求める
+    chap16_7_9::parallel_chunks(pool, first, last, [&](const T* f, const T* l) {
+        const std::size_t i = static_cast<std::size_t>(std::lower_bound(std::begin(starts), std::end(starts), f) - std::begin(starts));
+        scan(f, l, d_first + (f - first), offsets[i]);
+        return true;
+    });
+}
+
+template <class T>
+compensated<T> operator+(compensated<T> x, compensated<T> y) noexcept
+{
+    x.add(y.sum);
+    x.error += y.error;
+    return x;
+}
+
+} // namespace detail
+#endif
+
+/**
+ * @brief [ @a first, @a last ) の累積和(各要素自身を含む)を @a d_first に書き込みます
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param d_first 書き込み先の先頭へのポインタ。@a first と同じでも構いません
+ * @param pool 要素の数が TPLCXX17::chap16_7_9::parallel_threshold 以上の場合に用いるスレッドプール
+ * @return 書き込んだ範囲の終端へのポインタ
+ * @note 浮動小数点数の場合、結果はスレッドの数や SIMD 命令の有無によって僅かに変わり得ます
+ * @code
+ * void inclusive_scan_sample()
+ * {
+ *      std::vector<int> v { 3, 1, 4, 1, 5 };
+ *      TPLCXX17::chap16_7_10::inclusive_scan(v.data(), v.data() + v.size(), v.data()); // 3 4 8 9 14
+ * }
+ * @endcode
+ */
+template <class T>
+T* inclusive_scan(const T* first, const T* last, T* d_first, chap16_7_9::thread_pool& pool = chap16_7_9::thread_pool::instance())
+{
+    static_assert(std::is_arithmetic_v<T>);
+    auto scan = [](const T* f, const T* l, T* d, T carry) { detail::scan_serial<false>(f, l, d, carry); };
+    if (static_cast<std::size_t>(last - first) < chap16_7_9::parallel_threshold || pool.size() < 2) scan(first, last, d_first, T(0));
+    else detail::block_scan(first, last, d_first, T(0), pool, [](const T* f, const T* l) { return chap16_7_9::detail::reduce_serial<T>(f, l, std::plus<>()); }, scan);
+    return d_first + (last - first);
+}
+
+/**
+ * @brief [ @a first, @a last ) の累積和(各要素の直前まで)を @a d_first に書き込みます
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param d_first 書き込み先の先頭へのポインタ。@a first と同じでも構いません
+ * @param init 初期値
+ * @param pool 要素の数が TPLCXX17::chap16_7_9::parallel_threshold 以上の場合に用いるスレッドプール
+ * @return 書き込んだ範囲の終端へのポインタ
+ * @code
+ * void exclusive_scan_sample()
+ * {
+ *      // バケットごとの要素の数から、各バケットの書き込みを始める位置を求める
+ *      std::vector<std::uint32_t> histogram { 3, 1, 4, 1, 5 };
+ *      TPLCXX17::chap16_7_10::exclusive_scan(histogram.data(), histogram.data() + histogram.size(), histogram.data(), 0u); // 0 3 4 8 9
+ * }
+ * @endcode
+ */
+template <class T>
+T* exclusive_scan(const T* first, const T* last, T* d_first, T init, chap16_7_9::thread_pool& pool = chap16_7_9::thread_pool::instance())
+{
+    static_assert(std::is_arithmetic_v<T>);
+    auto scan = [](const T* f, const T* l, T* d, T carry) { detail::scan_serial<true>(f, l, d, carry); };
+    if (static_cast<std::size_t>(last - first) < chap16_7_9::parallel_threshold || pool.size() < 2) scan(first, last, d_first, init);
+    else detail::block_scan(first, last, d_first, init, pool, [](const T* f, const T* l) { return chap16_7_9::detail::reduce_serial<T>(f, l, std::plus<>()); }, scan);
+    return d_first + (last - first);
+}
+
+/**
+ * @brief [ @a first, @a last ) の累積和(各要素自身を含む)を、補正項によって誤差を抑えながら @a d_first に書き込みます
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param d_first 書き込み先の先頭へのポインタ。@a first と同じでも構いません
+ * @param pool 要素の数が TPLCXX17::chap16_7_9::parallel_threshold 以上の場合に用いるスレッドプール
+ * @return 書き込んだ範囲の終端へのポインタ
+ */
+template <class T>
+T* compensated_inclusive_scan(const T* first, const T* last, T* d_first, chap16_7_9::thread_pool& pool = chap16_7_9::thread_pool::instance())
+{
+    static_assert(std::is_floating_point_v<T>);
+    auto scan = [](const T* f, const T* l, T* d, detail::compensated<T> carry) { detail::compensated_scan_serial(f, l, d, carry); };
+    auto total = [](const T* f, const T* l) {
+        detail::compensated<T> r { 0, 0 };
+        for (; f != l; ++f) r.add(*f);
+        return r;
+    };
+    if (static_cast<std::size_t>(last - first) < chap16_7_9::parallel_threshold || pool.size() < 2) scan(first, last, d_first, { 0, 0 });
+    else detail::block_scan(first, last, d_first, detail::compensated<T> { 0, 0 }, pool, total, scan);
+    return d_first + (last - first);
+}
+
+} // namespace chap16_7_10
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <execution>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+
+template <class F>
+double best_seconds(F f)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < 5; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+template <class T>
+void run(const char* type, std::size_t n)
+{
+    namespace chap = TPLCXX17::chap16_7_10;
+
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<T> v(n), out(n);
+    for (T& x : v) x = static_cast<T>(dist(engine)) / 16;
+    std::vector<long double> expected(n); // long double で求めた累積和を真の値の代わりとする
+    long double acc = 0;
+    for (std::size_t i = 0; i < n; ++i) expected[i] = acc += v[i];
+
+    const double bytes = 2. * static_cast<double>(n * sizeof(T));
+    auto report = [&](const char* name, auto f) {
+        const double s = best_seconds(f);
+        long double max_error = 0; // 相対誤差の最大値
+        for (std::size_t i = 0; i < n; ++i) {
+            if (expected[i] != 0) max_error = std::max(max_error, std::fabs((out[i] - expected[i]) / expected[i]));
+        }
+        std::cout << type << " " << name << ": " << bytes / s * 1e-9 << " GB/s, max relative error = " << static_cast<double>(max_error) << std::endl;
+    };
+
+    TPLCXX17::chap16_7_9::thread_pool single(1);
+    report("std::partial_sum", [&] { std::partial_sum(std::begin(v), std::end(v), std::begin(out)); });
+    report("std::inclusive_scan(par)", [&] { std::inclusive_scan(std::execution::par, std::begin(v), std::end(v), std::begin(out)); });
+    report("inclusive_scan (1 thread)", [&] { chap::inclusive_scan(v.data(), v.data() + n, out.data(), single); });
+    report("inclusive_scan", [&] { chap::inclusive_scan(v.data(), v.data() + n, out.data()); });
+    if constexpr (std::is_floating_point_v<T>) {
+        report("compensated_inclusive_scan", [&] { chap::compensated_inclusive_scan(v.data(), v.data() + n, out.data()); });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(1) << 26;
+    std::cout << "threads: " << TPLCXX17::chap16_7_9::thread_pool::instance().size() << std::endl;
+    run<std::int32_t>("int32", n);
+    run<float>("float", n);
+    run<double>("double", n);
+}
+#endif
 /*@}*/
@@ -257,5 +257,2174 @@ for (int i = 0; i < 10000; ++i) {
     r -= f - t; // (4) r から (3) で加えることができた分を取り除く。
 }
 
+#endif
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace TPLCXX17 {
+//! chapter 16.8.10 namespace
+namespace chap16_8_10 {
+
+/**
+ * @brief 総和の求め方
+ */
+enum class summation { naive, pairwise, kahan, neumaier, reproducible };
+
+/**
+ * @brief summation の名前を返します
+ * @param s 総和の求め方
+ * @return 名前
+ */
+constexpr const char* to_string(summation s) noexcept
+{
+    switch (s) {
+    case summation::naive: return "naive";
+    case summation::pairwise: return "pairwise";
+    case summation::kahan: return "kahan";
+    case summation::neumaier: return "neumaier";
+    case summation::reproducible: return "reproducible";
+    }
+    return "";
+}
+
+/**
+ * @class exact_accumulator
+ * @brief 浮動小数点数型 @a T の値を、丸めることなく足し合わせます
+ * @code
+ * void exact_accumulator_sample()
+ * {
+ *      TPLCXX17::chap16_8_10::exact_accumulator<float> acc;
+ *      for (int i = 0; i < 10000; ++i) acc.add(0.01f);
+ *      [[maybe_unused]] float r = acc.result(); // 0.01f を 10000 回足し合わせた値を一度だけ丸めたもの
+ * }
+ * @endcode
+ */
+template <class T>
+class exact_accumulator {
+    static_assert(std::numeric_limits<T>::is_iec559 && (std::is_same_v<T, float> || std::is_same_v<T, double>));
+
+    typedef std::conditional_t<std::is_same_v<T, float>, std::uint32_t, std::uint64_t> bits_type;
+    static constexpr int mantissa_bits = std::numeric_limits<T>::digits - 1;
+    static constexpr int exponent_bits = sizeof(T) * CHAR_BIT - 1 - mantissa_bits;
+    static constexpr bits_type exponent_mask = (bits_type(1) << exponent_bits) - 1;
+    // 整数の最下位ビットが表す値の指数(float: -149, double: -1074)
+    static constexpr int min_exponent = std::numeric_limits<T>::min_exponent - std::numeric_limits<T>::digits;
+    // 32 ビットずつの桁の数。最大の値の最上位ビットを表せる数に、桁上がりのための 2 桁を加える
+    static constexpr std::size_t digits = (exponent_mask - 2 + mantissa_bits + 1) / 32 + 1 + 2;
+    // 各桁は 32 ビット未満の値を加えられるため、この回数ごとに桁上がりを処理すれば 64 ビットを超えない
+    static constexpr std::size_t normalize_interval = std::size_t(1) << 30;
+public:
+    /**
+     * @brief 値 @a x を加えます
+     * @param x 値
+     */
+    void add(T x) noexcept
+    {
+        bits_type b;
+        std::memcpy(&b, &x, sizeof b);
+        const bits_type exponent = (b >> mantissa_bits) & exponent_mask, mantissa = b & ((bits_type(1) << mantissa_bits) - 1);
+        const bool negative = b >> (sizeof(bits_type) * CHAR_BIT - 1);
+
+        if (exponent == exponent_mask) { // NaN と無限大
+            if (mantissa) nan_ = true;
+            else (negative ? negative_infinity_ : positive_infinity_) = true;
+            return;
+        }
+        const std::uint64_t m = exponent ? (mantissa | (bits_type(1) << mantissa_bits)) : mantissa; // 正規化数はケチ表現を戻す
+        if (!m) return;
+
+        // x = m * 2^(min_exponent + position)
+        const unsigned position = static_cast<unsigned>(exponent ? exponent : 1) - 1, shift = position % 32;
+        const std::size_t index = position / 32;
+        const std::uint64_t low = m << shift, high = shift ? m >> (64 - shift) : 0;
+        const std::int64_t d0 = low & 0xffffffff, d1 = low >> 32, d2 = high;
+        if (negative) {
+            digits_[index] -= d0;
+            digits_[index + 1] -= d1;
+            digits_[index + 2] -= d2;
+        } else {
+            digits_[index] += d0;
+            digits_[index + 1] += d1;
+            digits_[index + 2] += d2;
+        }
+        if (++count_ == normalize_interval) normalize();
+    }
+
+    /**
+     * @brief [ @a first, @a last ) の値を全て加えます
+     * @param first 先頭へのポインタ
+     * @param last 終端へのポインタ
+     */
+    void add(const T* first, const T* last) noexcept
+    {
+        for (; first != last; ++first) add(*first);
+    }
+
+    /**
+     * @brief 他の exact_accumulator が足し合わせた値を加えます
+     * @param other 他の exact_accumulator
+     */
+    void merge(exact_accumulator other) noexcept
+    {
+        other.normalize();
+        normalize();
+        for (std::size_t i = 0; i < digits; ++i) digits_[i] += other.digits_[i];
+        normalize();
+        nan_ |= other.nan_;
+        positive_infinity_ |= other.positive_infinity_;
+        negative_infinity_ |= other.negative_infinity_;
+    }
+
+    /**
+     * @brief 足し合わせた値を最近接偶数丸めによって @a T に丸めて返します
+     * @return 足し合わせた値
+     * @note 結果が非正規化数となる場合に限り、丸めが二度行われることがあります。NaN を加えた場合、または正と負の無限大を加えた場合は NaN を返します
+     */
+    T result() const noexcept
+    {
+        if (nan_ || (positive_infinity_ && negative_infinity_)) return std::numeric_limits<T>::quiet_NaN();
+        if (positive_infinity_) return std::numeric_limits<T>::infinity();
+        if (negative_infinity_) return -std::numeric_limits<T>::infinity();
+
+        exact_accumulator a = *this;
+        a.normalize();
+        const bool negative = a.digits_[digits - 1] < 0;
+        if (negative) {
+            for (std::int64_t& d : a.digits_) d = -d;
+            a.normalize();
+        }
+
+        std::size_t k = digits;
+        while (k != 0 && a.digits_[k - 1] == 0) --k;
+        if (k-- == 0) return T(0);
+
+        // 最上位の 1 から 64 ビットを取り出し、それより下位のビットは一つでも 1 があれば最下位ビットに 1 を立てる(sticky bit)
+        auto digit = [&a](std::size_t i) -> std::uint64_t { return i < digits ? static_cast<std::uint64_t>(a.digits_[i]) : 0; };
+        int top = 31;
+        while (!((digit(k) >> top) & 1)) --top;
+        const int shift = 31 - top;
+        const std::uint64_t d2 = digit(k), d1 = k >= 1 ? digit(k - 1) : 0, d0 = k >= 2 ? digit(k - 2) : 0;
+        std::uint64_t m = ((d2 << 32 | d1) << shift) | (d0 >> (32 - shift));
+        bool sticky = (d0 & ((std::uint64_t(1) << (32 - shift)) - 1)) != 0;
+        for (std::size_t i = 0; !sticky && i + 2 < k; ++i) sticky = a.digits_[i] != 0;
+        m |= sticky;
+
+        const int exponent = static_cast<int>(k * 32) + top - 63 + min_exponent;
+        const T r = std::ldexp(static_cast<T>(m), exponent);
+        return negative ? -r : r;
+    }
+private:
+    void normalize() noexcept
+    {
+        // 最上位以外の桁を [0, 2^32) に収め、桁上がりを上位の桁に加える
+        for (std::size_t i = 0; i + 1 < digits; ++i) {
+            const std::int64_t low = digits_[i] & 0xffffffff;
+            digits_[i + 1] += (digits_[i] - low) / (std::int64_t(1) << 32);
+            digits_[i] = low;
+        }
+        count_ = 0;
+    }
+
+    std::int64_t digits_[digits] {};
+    std::size_t count_ = 0;
+    bool nan_ = false, positive_infinity_ = false, negative_infinity_ = false;
+};
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+// 真の値は sum + error に近い
+template <class T>
+struct compensated {
+    T sum, error;
+};
+
+template <class T>
+compensated<T> neumaier_add(compensated<T> a, T x) noexcept
+{
+    const T t = a.sum + x;
+    a.error += std::fabs(a.sum) >= std::fabs(x) ? (a.sum - t) + x : (x - t) + a.sum;
+    a.sum = t;
+    return a;
+}
+
+template <class T>
+compensated<T> merge(compensated<T> a, compensated<T> b) noexcept
+{
+    a = neumaier_add(a, b.sum);
+    a.error += b.error;
+    return a;
+}
+
+// SIMD 命令のレジスタ一つ分の値を表す。SSE2 を利用できない場合は一要素のみ
+template <class T>
+struct lanes {
+    typedef T type;
+    static constexpr std::size_t width = 1;
+    static type zero() noexcept { return 0; }
+    static type load(const T* p) noexcept { return *p; }
+    static void store(T* p, type v) noexcept { *p = v; }
+    static type add(type x, type y) noexcept { return x + y; }
+    static type sub(type x, type y) noexcept { return x - y; }
+    static type neumaier_term(type s, type x, type t) noexcept { return std::fabs(s) >= std::fabs(x) ? (s - t) + x : (x - t) + s; }
+};
+
+#if defined(__SSE2__)
+template <>
+struct lanes<float> {
+    typedef __m128 type;
+    static constexpr std::size_t width = 4;
+    static type zero() noexcept { return _mm_setzero_ps(); }
+    static type load(const float* p) noexcept { return _mm_loadu_ps(p); }
+    static void store(float* p, type v) noexcept { _mm_storeu_ps(p, v); }
+    static type add(type x, type y) noexcept { return _mm_add_ps(x, y); }
+    static type sub(type x, type y) noexcept { return _mm_sub_ps(x, y); }
+    static type neumaier_term(type s, type x, type t) noexcept
+    {
+        const type sign = _mm_set1_ps(-0.f);
+        const type mask = _mm_cmpge_ps(_mm_andnot_ps(sign, s), _mm_andnot_ps(sign, x));
+        return _mm_or_ps(_mm_and_ps(mask, add(sub(s, t), x)), _mm_andnot_ps(mask, add(sub(x, t), s)));
+    }
+};
+
+template <>
+struct lanes<double> {
+    typedef __m128d type;
+    static constexpr std::size_t width = 2;
+    static type zero() noexcept { return _mm_setzero_pd(); }
+    static type load(const double* p) noexcept { return _mm_loadu_pd(p); }
+    static void store(double* p, type v) noexcept { _mm_storeu_pd(p, v); }
+    static type add(type x, type y) noexcept { return _mm_add_pd(x, y); }
+    static type sub(type x, type y) noexcept { return _mm_sub_pd(x, y); }
+    static type neumaier_term(type s, type x, type t) noexcept
+    {
+        const type sign = _mm_set1_pd(-0.);
+        const type mask = _mm_cmpge_pd(_mm_andnot_pd(sign, s), _mm_andnot_pd(sign, x));
+        return _mm_or_pd(_mm_and_pd(mask, add(sub(s, t), x)), _mm_andnot_pd(mask, add(sub(x, t), s)));
+    }
+};
+#endif
+
+// pairwise でこの要素数以下の区間は、レジスタの各要素ごとに順に足し合わせる
+constexpr std::size_t pairwise_block = 128;
+
+template <class T>
+T pairwise_sum(const T* first, const T* last) noexcept
+{
+    typedef lanes<T> L;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n > pairwise_block) {
+        const T* middle = first + n / 2;
+        return pairwise_sum(first, middle) + pairwise_sum(middle, last);
+    }
+
+    typename L::type a0 = L::zero(), a1 = L::zero();
+    for (; static_cast<std::size_t>(last - first) >= 2 * L::width; first += 2 * L::width) {
+        a0 = L::add(a0, L::load(first));
+        a1 = L::add(a1, L::load(first + L::width));
+    }
+    T s[L::width];
+    L::store(s, L::add(a0, a1));
+    for (std::size_t w = L::width / 2; w != 0; w /= 2) {
+        for (std::size_t i = 0; i < w; ++i) s[i] += s[i + w];
+    }
+    T r = s[0];
+    for (; first != last; ++first) r += *first;
+    return r;
+}
+
+template <class T>
+compensated<T> kahan_sum(const T* first, const T* last) noexcept
+{
+    typedef lanes<T> L;
+    typename L::type s = L::zero(), c = L::zero();
+    for (; static_cast<std::size_t>(last - first) >= L::width; first += L::width) {
+        const typename L::type y = L::sub(L::load(first), c);
+        const typename L::type t = L::add(s, y);
+        c = L::sub(L::sub(t, s), y); // 加えることのできなかった値の符号を反転したもの
+        s = t;
+    }
+    T ss[L::width], cs[L::width];
+    L::store(ss, s);
+    L::store(cs, c);
+    compensated<T> r { 0, 0 };
+    for (std::size_t i = 0; i < L::width; ++i) r = merge(r, compensated<T> { ss[i], -cs[i] });
+    for (; first != last; ++first) r = neumaier_add(r, *first);
+    return r;
+}
+
+template <class T>
+compensated<T> neumaier_sum(const T* first, const T* last) noexcept
+{
+    typedef lanes<T> L;
+    typename L::type s = L::zero(), c = L::zero();
+    for (; static_cast<std::size_t>(last - first) >= L::width; first += L::width) {
+        const typename L::type x = L::load(first), t = L::add(s, x);
+        c = L::add(c, L::neumaier_term(s, x, t));
+        s = t;
+    }
+    T ss[L::width], cs[L::width];
+    L::store(ss, s);
+    L::store(cs, c);
+    compensated<T> r { 0, 0 };
+    for (std::size_t i = 0; i < L::width; ++i) r = merge(r, compensated<T> { ss[i], cs[i] });
+    for (; first != last; ++first) r = neumaier_add(r, *first);
+    return r;
+}
+
+template <class T>
+compensated<T> sum_chunk(const T* first, const T* last, summation mode) noexcept
+{
+    switch (mode) {
+    case summation::naive: return { std::accumulate(first, last, T(0)), 0 };
+    case summation::pairwise: return { pairwise_sum(first, last), 0 };
+    case summation::kahan: return kahan_sum(first, last);
+    default: return neumaier_sum(first, last);
+    }
+}
+
+template <class T>
+T pairwise_merge(const std::vector<compensated<T>>& partial, std::size_t first, std::size_t last) noexcept
+{
+    if (last - first == 1) return partial[first].sum;
+    const std::size_t middle = first + (last - first) / 2;
+    return pairwise_merge(partial, first, middle) + pairwise_merge(partial, middle, last);
+}
+
+} // namespace detail
+#endif
+
+/**
+ * @brief [ @a first, @a last ) の総和を、@a mode の方式で求めます
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param mode 総和の求め方
+ * @param pool 要素の数が TPLCXX17::chap16_7_9::parallel_threshold 以上の場合に用いるスレッドプール
+ * @return 総和
+ * @note summation::reproducible 以外の方式では、結果はスレッドの数や SIMD 命令の有無によって変わり得ます。
+ * また、-ffast-math などの浮動小数点数の演算の順序を入れ替える最適化を有効にすると、kahan と neumaier の補正は失われます
+ * @code
+ * void sum_sample()
+ * {
+ *      const std::vector<float> v(10000, 0.01f);
+ *      [[maybe_unused]] float r = TPLCXX17::chap16_8_10::sum(v.data(), v.data() + v.size(), TPLCXX17::chap16_8_10::summation::reproducible);
+ * }
+ * @endcode
+ */
+template <class T>
+T sum(const T* first, const T* last, summation mode = summation::neumaier, chap16_7_9::thread_pool& pool = chap16_7_9::thread_pool::instance())
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "T must be float or double");
+    const bool parallel = static_cast<std::size_t>(last - first) >= chap16_7_9::parallel_threshold && pool.size() >= 2;
+
+    if (mode == summation::reproducible) {
+        auto chunk = [](const T* f, const T* l) {
+            exact_accumulator<T> a;
+            a.add(f, l);
+            return a;
+        };
+        if (!parallel) return chunk(first, last).result();
+
+        exact_accumulator<T> a;
+        for (const exact_accumulator<T>& p : chap16_7_9::parallel_chunks(pool, first, last, chunk)) a.merge(p);
+        return a.result();
+    }
+
+    auto chunk = [mode](const T* f, const T* l) { return detail::sum_chunk(f, l, mode); };
+    if (!parallel) {
+        const detail::compensated<T> r = chunk(first, last);
+        return r.sum + r.error;
+    }
+
+    const std::vector<detail::compensated<T>> partial = chap16_7_9::parallel_chunks(pool, first, last, chunk);
+    switch (mode) {
+    case summation::naive: {
+        T r = 0;
+        for (const detail::compensated<T>& p : partial) r += p.sum;
+        return r;
+    }
+    case summation::pairwise:
+        return detail::pairwise_merge(partial, 0, partial.size());
+    default: {
+        detail::compensated<T> r { 0, 0 };
+        for (const detail::compensated<T>& p : partial) r = detail::merge(r, p);
+        return r.sum + r.error;
+    }
+    }
+}
+
+} // namespace chap16_8_10
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+
+template <class T>
+bool bit_equal(T x, T y)
+{
+    return std::memcmp(&x, &y, sizeof x) == 0;
+}
+
+template <class T>
+void run(const char* name, const std::vector<T>& v)
+{
+    using namespace TPLCXX17::chap16_8_10;
+    namespace chap = TPLCXX17::chap16_7_9;
+
+    long double reference = 0;
+    for (T x : v) reference += x;
+    const std::vector<T> reversed(std::rbegin(v), std::rend(v));
+
+    std::vector<std::unique_ptr<chap::thread_pool>> pools;
+    for (std::size_t n = 1; n <= 4; ++n) pools.push_back(std::make_unique<chap::thread_pool>(n));
+
+    std::cout << name << " (n = " << v.size() << ", reference = " << std::setprecision(std::numeric_limits<long double>::max_digits10) << reference << ")" << std::endl;
+    for (summation mode : { summation::naive, summation::pairwise, summation::kahan, summation::neumaier, summation::reproducible }) {
+        T r = 0;
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < 3; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            r = sum(v.data(), v.data() + v.size(), mode);
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        bool reproducible = bit_equal(r, sum(reversed.data(), reversed.data() + reversed.size(), mode));
+        for (const auto& pool : pools) reproducible &= bit_equal(r, sum(v.data(), v.data() + v.size(), mode, *pool));
+
+        std::cout << "  " << std::left << std::setw(13) << to_string(mode) << std::right
+            << std::setprecision(std::numeric_limits<T>::max_digits10) << std::setw(26) << r
+            << "  relative error " << std::setprecision(3) << std::setw(9) << static_cast<double>(std::fabs((r - reference) / reference))
+            << "  " << std::setw(8) << static_cast<double>(v.size() * sizeof(T)) / best * 1e-9 << " GB/s"
+            << "  " << (reproducible ? "reproducible" : "not reproducible") << std::endl;
+    }
+}
+
+int main()
+{
+    std::mt19937 engine(42);
+
+    run("0.01f x 10000", std::vector<float>(10000, 0.01f));
+
+    std::uniform_real_distribution<float> uniform(0, 1);
+    std::vector<float> u(1 << 24);
+    for (float& x : u) x = uniform(engine);
+    run("float uniform [0, 1)", u);
+
+    // 符号がばらばらで、大きさが 2^-20 から 2^20 に渡る値
+    std::uniform_real_distribution<double> exponent(-20, 20), mantissa(-1, 1);
+    std::vector<double> w(1 << 24);
+    for (double& x : w) x = mantissa(engine) * std::exp2(exponent(engine));
+    run("double mixed signs and scales", w);
+}
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace TPLCXX17 {
+//! chapter 16.8.11 namespace
+namespace chap16_8_11 {
+
+/**
+ * @brief 演算の結果が表現できる範囲を超えた場合の振る舞い
+ */
+enum class overflow {
+    wrap,       //!< 上位のビットを捨てる
+    saturate    //!< 範囲の端の値に留める
+};
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+#ifdef __SIZEOF_INT128__
+typedef __int128 int128;
+typedef unsigned __int128 uint128;
+#endif
+
+template <std::size_t Bits, bool Signed>
+struct storage {
+    typedef std::conditional_t<(Bits <= 8), std::conditional_t<Signed, std::int8_t, std::uint8_t>,
+            std::conditional_t<(Bits <= 16), std::conditional_t<Signed, std::int16_t, std::uint16_t>,
+            std::conditional_t<(Bits <= 32), std::conditional_t<Signed, std::int32_t, std::uint32_t>,
+            std::conditional_t<Signed, std::int64_t, std::uint64_t>>>> type;
+};
+
+// 内部の表現同士の積が収まる符号付き整数型
+template <std::size_t Bits>
+struct wide {
+#ifdef __SIZEOF_INT128__
+    typedef std::conditional_t<(Bits < 32), std::int64_t, int128> type;
+    typedef std::conditional_t<(Bits < 32), std::uint64_t, uint128> unsigned_type;
+#else
+    static_assert(Bits < 32, "fixed_point wider than 31 bits requires __int128");
+    typedef std::int64_t type;
+    typedef std::uint64_t unsigned_type;
+#endif
+};
+
+// 2^s で割り、最も近い値に丸める(中間の値は正の無限大の方向)。負の値の右シフトは算術シフトであることを前提とする
+template <class W>
+constexpr W round_shift(W v, std::size_t s) noexcept
+{
+    return s == 0 ? v : (v + (W(1) << (s - 1))) >> s;
+}
+
+} // namespace detail
+#endif
+
+/**
+ * @class fixed_point
+ * @brief Number part を @a IntBits ビット、fractional part を @a FracBits ビットとする固定小数点数型
+ * @tparam IntBits Number part のビット数(符号ビットを含まない)
+ * @tparam FracBits fractional part のビット数
+ * @tparam Signed 符号の有無
+ * @tparam Policy 演算の結果が表現できる範囲を超えた場合の振る舞い
+ * @note 内部の表現には、符号ビットを含めて IntBits + FracBits + Signed ビットが収まる最小の整数型を用います。
+ * 丸めは全て、最も近い値への丸め(中間の値は正の無限大の方向)です
+ * @code
+ * void fixed_point_sample()
+ * {
+ *      typedef TPLCXX17::chap16_8_11::fixed_point<7, 8> q7_8;
+ *      constexpr q7_8 a(1.5), b(-2.25);
+ *      constexpr q7_8 c = a * b + q7_8(1);  // -2.375
+ *      static_assert(c == q7_8(-2.375));
+ *      static_assert(q7_8::max() + q7_8(1) == q7_8::max()); // 飽和
+ * }
+ * @endcode
+ */
+template <std::size_t IntBits, std::size_t FracBits, bool Signed = true, overflow Policy = overflow::saturate>
+class fixed_point {
+public:
+    //! 符号ビットを含めた全体のビット数
+    static constexpr std::size_t total_bits = IntBits + FracBits + Signed;
+    static_assert(total_bits > 0 && total_bits <= 64, "fixed_point must fit in 64 bits");
+
+    static constexpr std::size_t integer_bits = IntBits;     //!< Number part のビット数
+    static constexpr std::size_t fractional_bits = FracBits; //!< fractional part のビット数
+    static constexpr bool is_signed = Signed;                 //!< 符号の有無
+    static constexpr overflow policy = Policy;                //!< オーバーフローポリシー
+
+    //! 内部の表現の型
+    typedef typename detail::storage<total_bits, Signed>::type value_type;
+    //! 演算の途中結果に用いる型
+    typedef typename detail::wide<total_bits>::type wide_type;
+private:
+    typedef typename detail::wide<total_bits>::unsigned_type unsigned_wide_type;
+
+    static constexpr wide_type raw_max = (wide_type(1) << (IntBits + FracBits)) - 1;
+    static constexpr wide_type raw_min = Signed ? -(wide_type(1) << (IntBits + FracBits)) : 0;
+    static constexpr wide_type one = wide_type(1) << FracBits;
+public:
+    /**
+     * @brief 演算の途中結果を、オーバーフローポリシーに従って内部の表現に収めます
+     * @param v 演算の途中結果
+     * @return 内部の表現
+     */
+    static constexpr value_type narrow(wide_type v) noexcept
+    {
+        if constexpr (Policy == overflow::saturate) {
+            return static_cast<value_type>(v > raw_max ? raw_max : v < raw_min ? raw_min : v);
+        } else {
+            const unsigned_wide_type mask = (unsigned_wide_type(1) << (total_bits - 1) << 1) - 1;
+            const unsigned_wide_type u = static_cast<unsigned_wide_type>(v) & mask;
+            if (Signed && (u >> (total_bits - 1)) & 1) return static_cast<value_type>(static_cast<wide_type>(u) - static_cast<wide_type>(mask) - 1);
+            return static_cast<value_type>(u);
+        }
+    }
+
+    /**
+     * @brief デフォルトコンストラクタ。値は 0 となります
+     */
+    constexpr fixed_point() = default;
+
+    /**
+     * @brief 整数から構築します
+     * @param x 整数
+     */
+    template <class Integer, std::enable_if_t<std::is_integral_v<Integer>, std::nullptr_t> = nullptr>
+    constexpr explicit fixed_point(Integer x) noexcept : data_(from_integer(x)) {}
+
+    /**
+     * @brief 浮動小数点数から構築します
+     * @param x 浮動小数点数
+     * @note オーバーフローポリシーによらず、範囲外の値は範囲の端の値に、NaN は 0 になります
+     */
+    template <class Floating, std::enable_if_t<std::is_floating_point_v<Floating>, std::nullptr_t> = nullptr>
+    constexpr explicit fixed_point(Floating x) noexcept : data_(from_floating(x)) {}
+
+    /**
+     * @brief 内部の表現から構築します
+     * @param raw 内部の表現(値を 2 の FracBits 乗倍した整数)
+     * @return 構築した値
+     */
+    static constexpr fixed_point from_raw(value_type raw) noexcept
+    {
+        fixed_point r;
+        r.data_ = raw;
+        return r;
+    }
+
+    //! 表現できる最大の値を返します
+    static constexpr fixed_point max() noexcept { return from_raw(static_cast<value_type>(raw_max)); }
+    //! 表現できる最小の値を返します
+    static constexpr fixed_point lowest() noexcept { return from_raw(static_cast<value_type>(raw_min)); }
+    //! 表現できる最小の正の値を返します
+    static constexpr fixed_point epsilon() noexcept { return from_raw(1); }
+
+    /**
+     * @brief 内部の表現を返します
+     * @return 内部の表現
+     */
+    constexpr value_type raw() const noexcept { return data_; }
+
+    /**
+     * @brief 浮動小数点数に変換します
+     * @return 変換した値
+     */
+    template <class Floating, std::enable_if_t<std::is_floating_point_v<Floating>, std::nullptr_t> = nullptr>
+    constexpr explicit operator Floating() const noexcept { return static_cast<Floating>(data_) / static_cast<Floating>(one); }
+
+    constexpr fixed_point operator+() const noexcept { return *this; }
+    constexpr fixed_point operator-() const noexcept { return from_raw(narrow(-static_cast<wide_type>(data_))); }
+
+    constexpr fixed_point& operator+=(fixed_point x) noexcept { return *this = *this + x; }
+    constexpr fixed_point& operator-=(fixed_point x) noexcept { return *this = *this - x; }
+    constexpr fixed_point& operator*=(fixed_point x) noexcept { return *this = *this * x; }
+    constexpr fixed_point& operator/=(fixed_point x) { return *this = *this / x; }
+private:
+    template <class Integer>
+    static constexpr value_type from_integer(Integer x) noexcept
+    {
+        if constexpr (Policy == overflow::saturate) {
+            // 広い型での乗算が溢れないよう、先に範囲を確かめる
+            if (x >= 0 && static_cast<std::make_unsigned_t<Integer>>(x) > static_cast<unsigned_wide_type>(raw_max >> FracBits)) return static_cast<value_type>(raw_max);
+            if constexpr (std::is_signed_v<Integer>) {
+                if (x < 0 && static_cast<wide_type>(x) < (raw_min >> FracBits)) return static_cast<value_type>(raw_min);
+            }
+            return narrow(static_cast<wide_type>(x) * one);
+        } else {
+            return narrow(static_cast<wide_type>(static_cast<unsigned_wide_type>(x) << FracBits));
+        }
+    }
+
+    template <class Floating>
+    static constexpr value_type from_floating(Floating x) noexcept
+    {
+        if (x != x) return 0; // NaN
+        const Floating s = x * static_cast<Floating>(one);
+        if (s >= static_cast<Floating>(raw_max)) return static_cast<value_type>(raw_max);
+        if (s <= static_cast<Floating>(raw_min)) return static_cast<value_type>(raw_min);
+
+        wide_type w = static_cast<wide_type>(s); // 0 の方向への切り捨て
+        const Floating f = s - static_cast<Floating>(w);
+        if (f >= Floating(0.5)) ++w;
+        else if (f < Floating(-0.5)) --w;
+        return narrow(w);
+    }
+
+    friend constexpr fixed_point operator+(fixed_point x, fixed_point y) noexcept
+    {
+        return from_raw(narrow(static_cast<wide_type>(x.data_) + y.data_));
+    }
+
+    friend constexpr fixed_point operator-(fixed_point x, fixed_point y) noexcept
+    {
+        return from_raw(narrow(static_cast<wide_type>(x.data_) - y.data_));
+    }
+
+    // 64 ビットの符号なしの形式の積や、符号付きの形式の最小の値同士の商は wide_type に収まらないため、
+    // 乗算と除算は絶対値について unsigned_wide_type で行い、符号は別に扱う
+    static constexpr unsigned_wide_type magnitude(value_type v) noexcept
+    {
+        return v < 0 ? unsigned_wide_type(0) - static_cast<unsigned_wide_type>(v) : static_cast<unsigned_wide_type>(v);
+    }
+
+    // 絶対値 m と符号から、オーバーフローポリシーに従って内部の表現に収める
+    static constexpr value_type narrow_magnitude(unsigned_wide_type m, bool negative) noexcept
+    {
+        if constexpr (Policy == overflow::saturate) {
+            if (!negative) return m > static_cast<unsigned_wide_type>(raw_max) ? static_cast<value_type>(raw_max) : static_cast<value_type>(m);
+            return m > static_cast<unsigned_wide_type>(-raw_min) ? static_cast<value_type>(raw_min) : static_cast<value_type>(-static_cast<wide_type>(m));
+        } else {
+            return narrow(static_cast<wide_type>(negative ? unsigned_wide_type(0) - m : m));
+        }
+    }
+
+    friend constexpr fixed_point operator*(fixed_point x, fixed_point y) noexcept
+    {
+        const bool negative = (x.data_ < 0) != (y.data_ < 0);
+        const unsigned_wide_type p = magnitude(x.data_) * magnitude(y.data_);
+        if constexpr (FracBits == 0) {
+            return from_raw(narrow_magnitude(p, negative));
+        } else {
+            // 中間の値は正の無限大の方向に丸めるため、負の値の場合は絶対値を小さくする方向に丸める
+            const unsigned_wide_type half = unsigned_wide_type(1) << (FracBits - 1);
+            return from_raw(narrow_magnitude(negative ? (p + half - 1) >> FracBits : (p + half) >> FracBits, negative));
+        }
+    }
+
+    friend constexpr fixed_point operator/(fixed_point x, fixed_point y)
+    {
+        if (y.data_ == 0) throw std::domain_error(__func__ + std::string(": division by zero"));
+        // x * 2^FracBits / y を最も近い値に丸める
+        const bool negative = (x.data_ < 0) != (y.data_ < 0);
+        const unsigned_wide_type n = magnitude(x.data_) << FracBits, d = magnitude(y.data_);
+        unsigned_wide_type q = n / d;
+        const unsigned_wide_type r = n % d;
+        if (negative ? r > d - r : r >= d - r) ++q;
+        return from_raw(narrow_magnitude(q, negative));
+    }
+
+    friend constexpr bool operator==(fixed_point x, fixed_point y) noexcept { return x.data_ == y.data_; }
+    friend constexpr bool operator!=(fixed_point x, fixed_point y) noexcept { return x.data_ != y.data_; }
+    friend constexpr bool operator<(fixed_point x, fixed_point y) noexcept { return x.data_ < y.data_; }
+    friend constexpr bool operator>(fixed_point x, fixed_point y) noexcept { return x.data_ > y.data_; }
+    friend constexpr bool operator<=(fixed_point x, fixed_point y) noexcept { return x.data_ <= y.data_; }
+    friend constexpr bool operator>=(fixed_point x, fixed_point y) noexcept { return x.data_ >= y.data_; }
+
+    //! 値を 2 の FracBits 乗倍した整数
+    value_type data_ = 0;
+};
+
+/**
+ * @brief 丸めることなく乗算を行います
+ * @param x 固定小数点数
+ * @param y 固定小数点数
+ * @return @a x と @a y の積。Number part と fractional part のビット数はそれぞれの和(共に符号付きの場合、Number part は 1 ビット多く)となります
+ * @code
+ * void widening_multiply_sample()
+ * {
+ *      typedef TPLCXX17::chap16_8_11::fixed_point<0, 15> q0_15;
+ *      constexpr auto r = TPLCXX17::chap16_8_11::widening_multiply(q0_15::lowest(), q0_15::lowest()); // Q1.30 の 1
+ *      static_assert(static_cast<double>(r) == 1.0);
+ * }
+ * @endcode
+ */
+template <std::size_t I1, std::size_t F1, bool S1, overflow P1, std::size_t I2, std::size_t F2, bool S2, overflow P2>
+constexpr fixed_point<I1 + I2 + (S1 && S2), F1 + F2, S1 || S2, P1>
+widening_multiply(fixed_point<I1, F1, S1, P1> x, fixed_point<I2, F2, S2, P2> y) noexcept
+{
+    typedef fixed_point<I1 + I2 + (S1 && S2), F1 + F2, S1 || S2, P1> result_type;
+    typedef typename result_type::wide_type wide_type;
+    return result_type::from_raw(static_cast<typename result_type::value_type>(static_cast<wide_type>(x.raw()) * static_cast<wide_type>(y.raw())));
+}
+
+} // namespace chap16_8_11
+} // namespace TPLCXX17
+typedef TPLCXX17::chap16_8_11::fixed_point<32, 32, false> uq32_32;
+typedef TPLCXX17::chap16_8_11::fixed_point<0, 63> q0_63;
+static_assert(uq32_32::max() * uq32_32::max() == uq32_32::max()); // 飽和
+static_assert(uq32_32(65536) * uq32_32(65536) == uq32_32::max());
+static_assert(uq32_32(3) * uq32_32(0.5) == uq32_32(1.5));
+static_assert(uq32_32::max() / uq32_32::epsilon() == uq32_32::max());
+static_assert(q0_63::lowest() / q0_63::lowest() == q0_63::max()); // 1 は表せないため飽和
+static_assert(q0_63::lowest() * q0_63::lowest() == q0_63::max());
+static_assert(q0_63(-0.5) / q0_63::lowest() == q0_63(0.5));
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace TPLCXX17 {
+namespace chap16_8_11 {
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+template <class Fixed>
+struct is_simd_q15 : std::false_type {};
+
+template <std::size_t I, std::size_t F, overflow P>
+struct is_simd_q15<fixed_point<I, F, true, P>> : std::bool_constant<I + F == 15> {};
+
+// 内積の途中結果。64 ビットの形式の積は 2^126(符号なしでは 2^128)近くになり、二つ足すだけで int128 から溢れるため、
+// 積の和を、下位の U のビット数分 low と、それより上の桁 high(符号付き)とに分けて持つ
+template <class U>
+struct wide_accumulator {
+    U low;
+    std::int64_t high;
+
+    template <class W>
+    void add(W p) noexcept
+    {
+        const U u = static_cast<U>(p);
+        low += u;
+        high += low < u; // 桁上がり
+        if constexpr (W(-1) < W(0)) high -= p < 0; // 厳密な C++17 のモードでは std::is_signed_v<int128> が false となるため
+    }
+
+    // 2^s で割り、最も近い値に丸める(中間の値は正の無限大の方向)
+    void round_shift(std::size_t s) noexcept
+    {
+        if (s == 0) return;
+        const U half = U(1) << (s - 1);
+        low += half;
+        high += low < half;
+        low = (low >> s) | (static_cast<U>(high) << (sizeof(U) * CHAR_BIT - s));
+        high = s < 64 ? high >> s : -std::int64_t(high < 0); // 符号なしの Q0.64 では s が 64 となる
+    }
+};
+
+template <class Fixed>
+using dot_accumulator_t = wide_accumulator<typename wide<Fixed::total_bits>::unsigned_type>;
+
+} // namespace detail
+#endif
+
+/**
+ * @brief d_first[i] = first[i] + first2[i] を [ @a first, @a last ) の各要素について行います
+ * @param first 一つ目の列の先頭へのポインタ
+ * @param last 一つ目の列の終端へのポインタ
+ * @param first2 二つ目の列の先頭へのポインタ
+ * @param d_first 書き込み先の先頭へのポインタ
+ */
+template <class Fixed>
+void add(const Fixed* first, const Fixed* last, const Fixed* first2, Fixed* d_first) noexcept
+{
+#if defined(__SSE2__)
+    if constexpr (detail::is_simd_q15<Fixed>::value) {
+        for (; last - first >= 8; first += 8, first2 += 8, d_first += 8) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d_first), Fixed::policy == overflow::saturate ? _mm_adds_epi16(a, b) : _mm_add_epi16(a, b));
+        }
+    }
+#endif
+    for (; first != last; ++first, ++first2, ++d_first) *d_first = *first + *first2;
+}
+
+/**
+ * @brief d_first[i] = d_first[i] + first[i] * first2[i] を [ @a first, @a last ) の各要素について行います
+ * @param first 一つ目の列の先頭へのポインタ
+ * @param last 一つ目の列の終端へのポインタ
+ * @param first2 二つ目の列の先頭へのポインタ
+ * @param d_first 加算先の先頭へのポインタ
+ * @note 積を丸めた後、加算の結果にオーバーフローポリシーを一度だけ適用します
+ */
+template <class Fixed>
+void multiply_accumulate(const Fixed* first, const Fixed* last, const Fixed* first2, Fixed* d_first) noexcept
+{
+    typedef typename Fixed::wide_type wide_type;
+#if defined(__SSE2__)
+    if constexpr (detail::is_simd_q15<Fixed>::value) {
+        const __m128i half = _mm_set1_epi32(Fixed::fractional_bits ? 1 << (Fixed::fractional_bits - 1) : 0);
+        auto narrow = [](__m128i x, __m128i y) {
+            if constexpr (Fixed::policy == overflow::saturate) return _mm_packs_epi32(x, y);
+            return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(x, 16), 16), _mm_srai_epi32(_mm_slli_epi32(y, 16), 16));
+        };
+        for (; last - first >= 8; first += 8, first2 += 8, d_first += 8) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first2));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i*>(d_first));
+            const __m128i lo = _mm_mullo_epi16(a, b), hi = _mm_mulhi_epi16(a, b);
+            const __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), half), Fixed::fractional_bits);
+            const __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), half), Fixed::fractional_bits);
+            const __m128i d0 = _mm_srai_epi32(_mm_unpacklo_epi16(d, d), 16), d1 = _mm_srai_epi32(_mm_unpackhi_epi16(d, d), 16);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d_first), narrow(_mm_add_epi32(d0, p0), _mm_add_epi32(d1, p1)));
+        }
+    }
+#endif
+    for (; first != last; ++first, ++first2, ++d_first) {
+        if constexpr (Fixed::is_signed) {
+            const wide_type p = detail::round_shift(static_cast<wide_type>(first->raw()) * first2->raw(), Fixed::fractional_bits);
+            *d_first = Fixed::from_raw(Fixed::narrow(d_first->raw() + p));
+        } else {
+            // 符号なしの 64 ビットの形式の積は wide_type に収まらないため、符号なしで計算する
+            typedef typename detail::wide<Fixed::total_bits>::unsigned_type unsigned_wide_type;
+            const unsigned_wide_type p = detail::round_shift(static_cast<unsigned_wide_type>(first->raw()) * first2->raw(), Fixed::fractional_bits);
+            unsigned_wide_type s = d_first->raw() + p;
+            if (Fixed::policy == overflow::saturate && s > Fixed::max().raw()) s = Fixed::max().raw();
+            *d_first = Fixed::from_raw(Fixed::narrow(static_cast<wide_type>(s)));
+        }
+    }
+}
+
+/**
+ * @brief [ @a first, @a last ) と @a first2 から始まる列の内積を求めます
+ * @param first 一つ目の列の先頭へのポインタ
+ * @param last 一つ目の列の終端へのポインタ
+ * @param first2 二つ目の列の先頭へのポインタ
+ * @return 内積。全ての積を丸めずに足し合わせ、最後に一度だけ丸めた値です
+ * @code
+ * void dot_sample()
+ * {
+ *      typedef TPLCXX17::chap16_8_11::fixed_point<0, 63> q0_63;
+ *      const q0_63 a[] { q0_63::lowest(), q0_63::lowest() };
+ *      const q0_63 r = TPLCXX17::chap16_8_11::dot(a, a + 2, a); // 真の値は 2 であるため、q0_63::max() に飽和する
+ * }
+ * @endcode
+ */
+template <class Fixed>
+Fixed dot(const Fixed* first, const Fixed* last, const Fixed* first2) noexcept
+{
+    typedef typename Fixed::wide_type wide_type;
+    typedef typename detail::wide<Fixed::total_bits>::unsigned_type unsigned_wide_type;
+    typedef std::conditional_t<Fixed::is_signed, wide_type, unsigned_wide_type> product_type;
+    detail::dot_accumulator_t<Fixed> r {};
+#if defined(__SSE2__)
+    if constexpr (detail::is_simd_q15<Fixed>::value) {
+        const __m128i overflowed = _mm_set1_epi32(std::numeric_limits<std::int32_t>::min());
+        __m128i acc0 = _mm_setzero_si128(), acc1 = acc0;
+        for (; last - first >= 8; first += 8, first2 += 8) {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first2));
+            const __m128i m = _mm_madd_epi16(a, b);
+            // 上位 32 ビット。-2^31 は本来 2^31 であるため、上位を 0 とする
+            const __m128i high = _mm_xor_si128(_mm_srai_epi32(m, 31), _mm_cmpeq_epi32(m, overflowed));
+            acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(m, high));
+            acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(m, high));
+        }
+        alignas(16) std::int64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(acc0, acc1));
+        r.add(lanes[0]);
+        r.add(lanes[1]);
+    }
+#endif
+    for (; first != last; ++first, ++first2) r.add(static_cast<product_type>(first->raw()) * first2->raw());
+
+    r.round_shift(Fixed::fractional_bits);
+    // 飽和させる場合、wide_type に収まらない値は先に範囲の端の値とする。折り返す場合は下位のビットのみで決まる
+    if (Fixed::policy == overflow::saturate) {
+        const unsigned_wide_type hi = ~unsigned_wide_type(0) >> 1; // wide_type の最大値
+        if (r.high > 0 || (r.high == 0 && r.low > hi)) return Fixed::max();
+        if (r.high < -1 || (r.high == -1 && r.low <= hi)) return Fixed::lowest();
+    }
+    return Fixed::from_raw(Fixed::narrow(static_cast<wide_type>(r.low)));
+}
+
+} // namespace chap16_8_11
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+template <class F>
+double ns_per_element(std::size_t n, F f)
+{
+    constexpr int repeat = 2000;
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < 5; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int j = 0; j < repeat; ++j) f();
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (repeat * n));
+    }
+    return best;
+}
+
+int main()
+{
+    namespace chap = TPLCXX17::chap16_8_11;
+    typedef chap::fixed_point<2, 13> q2_13;
+    constexpr std::size_t n = 4096;
+
+    std::mt19937 engine(42);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    std::vector<float> fa(n), fb(n), fd(n);
+    std::vector<q2_13> qa(n), qb(n), qd(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        fa[i] = dist(engine);
+        fb[i] = dist(engine);
+        qa[i] = q2_13(fa[i]);
+        qb[i] = q2_13(fb[i]);
+    }
+
+    volatile float fsink;
+    volatile std::int16_t qsink;
+    std::cout << "add  float: " << ns_per_element(n, [&] { for (std::size_t i = 0; i < n; ++i) fd[i] = fa[i] + fb[i]; fsink = fd[0]; }) << " ns"
+        << ", Q2.13: " << ns_per_element(n, [&] { chap::add(qa.data(), qa.data() + n, qb.data(), qd.data()); qsink = qd[0].raw(); }) << " ns" << std::endl;
+    std::cout << "mac  float: " << ns_per_element(n, [&] { for (std::size_t i = 0; i < n; ++i) fd[i] += fa[i] * fb[i]; fsink = fd[0]; }) << " ns"
+        << ", Q2.13: " << ns_per_element(n, [&] { chap::multiply_accumulate(qa.data(), qa.data() + n, qb.data(), qd.data()); qsink = qd[0].raw(); }) << " ns" << std::endl;
+    std::cout << "dot  float: " << ns_per_element(n, [&] { float s = 0; for (std::size_t i = 0; i < n; ++i) s += fa[i] * fb[i]; fsink = s; }) << " ns"
+        << ", Q2.13: " << ns_per_element(n, [&] { qsink = chap::dot(qa.data(), qa.data() + n, qb.data()).raw(); }) << " ns" << std::endl;
+
+    float fdot = 0;
+    for (std::size_t i = 0; i < n; ++i) fdot += fa[i] * fb[i];
+    std::cout << "dot: float " << fdot << ", Q2.13 " << static_cast<float>(chap::dot(qa.data(), qa.data() + n, qb.data())) << std::endl;
+}
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace TPLCXX17 {
+//! chapter 16.8.12 namespace
+namespace chap16_8_12 {
+
+/**
+ * @class conversion_result
+ * @brief 浮動小数点数から固定小数点数への変換の結果
+ */
+struct conversion_result {
+    std::size_t nan = 0;        //!< NaN の数
+    std::size_t saturated = 0;  //!< 範囲外のため飽和させた値(無限大を含む)の数
+};
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+template <class Fixed, class Floating>
+struct is_simd_convertible
+    : std::bool_constant<
+        (std::is_same_v<Floating, float> || std::is_same_v<Floating, double>) &&
+        (std::is_same_v<typename Fixed::value_type, std::int16_t> || std::is_same_v<typename Fixed::value_type, std::int32_t>) &&
+        Fixed::total_bits <= std::numeric_limits<Floating>::digits
+    > {};
+
+// 2 の e 乗をコンパイル時に求める
+template <class Floating>
+constexpr Floating exp2(int e) noexcept
+{
+    return e == 0 ? Floating(1) : e > 0 ? 2 * exp2<Floating>(e - 1) : exp2<Floating>(e + 1) / 2;
+}
+
+#if defined(__SSE2__)
+// 4 つの値を 2^n 倍して範囲に収め、最も近い 32 ビット整数に丸める。nan と saturated は該当する要素が -1、それ以外が 0 となる
+inline void convert4(const float* p, float scale, float lo, float hi, __m128i& r, __m128i& nan, __m128i& saturated) noexcept
+{
+    const __m128 s = _mm_mul_ps(_mm_loadu_ps(p), _mm_set1_ps(scale)), l = _mm_set1_ps(lo), h = _mm_set1_ps(hi);
+    nan = _mm_castps_si128(_mm_cmpunord_ps(s, s));
+    saturated = _mm_castps_si128(_mm_or_ps(_mm_cmpgt_ps(s, h), _mm_cmplt_ps(s, l)));
+    const __m128 c = _mm_min_ps(_mm_max_ps(s, l), h); // NaN は lo となる
+
+    const __m128i w = _mm_cvttps_epi32(c);
+    const __m128 f = _mm_sub_ps(c, _mm_cvtepi32_ps(w));
+    const __m128i up = _mm_castps_si128(_mm_cmpge_ps(f, _mm_set1_ps(0.5f))), down = _mm_castps_si128(_mm_cmplt_ps(f, _mm_set1_ps(-0.5f)));
+    r = _mm_add_epi32(_mm_sub_epi32(w, up), down); // 比較の結果は -1 であるため、減算で 1 を加え、加算で 1 を引く
+}
+
+inline void convert4(const double* p, double scale, double lo, double hi, __m128i& r, __m128i& nan, __m128i& saturated) noexcept
+{
+    __m128i rs[2], ns[2], ss[2];
+    const __m128d l = _mm_set1_pd(lo), h = _mm_set1_pd(hi), half = _mm_set1_pd(0.5);
+    for (int i = 0; i < 2; ++i) {
+        // 64 ビットの比較の結果を、下位 2 つの 32 ビットの要素に詰める
+        auto compress = [](__m128d m) { return _mm_shuffle_epi32(_mm_castpd_si128(m), _MM_SHUFFLE(3, 3, 2, 0)); };
+        const __m128d s = _mm_mul_pd(_mm_loadu_pd(p + 2 * i), _mm_set1_pd(scale));
+        ns[i] = compress(_mm_cmpunord_pd(s, s));
+        ss[i] = compress(_mm_or_pd(_mm_cmpgt_pd(s, h), _mm_cmplt_pd(s, l)));
+        const __m128d c = _mm_min_pd(_mm_max_pd(s, l), h);
+
+        const __m128i w = _mm_cvttpd_epi32(c);
+        const __m128d f = _mm_sub_pd(c, _mm_cvtepi32_pd(w));
+        rs[i] = _mm_add_epi32(_mm_sub_epi32(w, compress(_mm_cmpge_pd(f, half))), compress(_mm_cmplt_pd(f, _mm_sub_pd(_mm_setzero_pd(), half))));
+    }
+    r = _mm_unpacklo_epi64(rs[0], rs[1]);
+    nan = _mm_unpacklo_epi64(ns[0], ns[1]);
+    saturated = _mm_unpacklo_epi64(ss[0], ss[1]);
+}
+
+inline void store4(float* p, __m128i v, float inverse) noexcept
+{
+    _mm_storeu_ps(p, _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(inverse)));
+}
+
+inline void store4(double* p, __m128i v, double inverse) noexcept
+{
+    _mm_storeu_pd(p, _mm_mul_pd(_mm_cvtepi32_pd(v), _mm_set1_pd(inverse)));
+    _mm_storeu_pd(p + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(v, _MM_SHUFFLE(3, 2, 3, 2))), _mm_set1_pd(inverse)));
+}
+#endif
+
+} // namespace detail
+#endif
+
+/**
+ * @brief 浮動小数点数の列 [ @a first, @a last ) を、固定小数点数の列に変換して @a d_first に書き込みます
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param d_first 書き込み先の先頭へのポインタ
+ * @param nan_value NaN を変換した結果とする値
+ * @return NaN の数と、範囲外のため飽和させた値の数
+ * @note 変換の規則は TPLCXX17::chap16_8_11::fixed_point のコンストラクタと同じです
+ * @code
+ * void to_fixed_sample()
+ * {
+ *      typedef TPLCXX17::chap16_8_11::fixed_point<2, 13> q2_13;
+ *      const std::vector<float> frame { 0.5f, -1.25f, 100.f, std::numeric_limits<float>::quiet_NaN() };
+ *      std::vector<q2_13> out(frame.size());
+ *      auto r = TPLCXX17::chap16_8_12::to_fixed(frame.data(), frame.data() + frame.size(), out.data()); // r.nan == 1, r.saturated == 1
+ * }
+ * @endcode
+ */
+template <class Floating, class Fixed>
+conversion_result to_fixed(const Floating* first, const Floating* last, Fixed* d_first, Fixed nan_value = Fixed()) noexcept
+{
+    static_assert(std::is_floating_point_v<Floating>);
+    constexpr Floating scale = detail::exp2<Floating>(static_cast<int>(Fixed::fractional_bits));
+    constexpr Floating hi = static_cast<Floating>(Fixed::max().raw()), lo = static_cast<Floating>(Fixed::lowest().raw());
+
+    conversion_result result;
+#if defined(__SSE2__)
+    if constexpr (detail::is_simd_convertible<Fixed, Floating>::value) {
+        typedef typename Fixed::value_type value_type;
+        const __m128i nv = _mm_set1_epi32(nan_value.raw());
+        __m128i nan_count = _mm_setzero_si128(), saturated_count = _mm_setzero_si128();
+        for (; last - first >= 8; first += 8, d_first += 8) {
+            __m128i r[2];
+            for (int i = 0; i < 2; ++i) {
+                __m128i nan, saturated;
+                detail::convert4(first + 4 * i, scale, lo, hi, r[i], nan, saturated);
+                r[i] = _mm_or_si128(_mm_and_si128(nan, nv), _mm_andnot_si128(nan, r[i]));
+                nan_count = _mm_sub_epi32(nan_count, nan);
+                saturated_count = _mm_sub_epi32(saturated_count, saturated);
+            }
+            if constexpr (std::is_same_v<value_type, std::int16_t>) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(d_first), _mm_packs_epi32(r[0], r[1]));
+            } else {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(d_first), r[0]);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(d_first + 4), r[1]);
+            }
+        }
+        alignas(16) std::uint32_t n[4], s[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(n), nan_count);
+        _mm_store_si128(reinterpret_cast<__m128i*>(s), saturated_count);
+        for (int i = 0; i < 4; ++i) {
+            result.nan += n[i];
+            result.saturated += s[i];
+        }
+    }
+#endif
+    for (; first != last; ++first, ++d_first) {
+        const Floating s = *first * scale;
+        if (s != s) {
+            ++result.nan;
+            *d_first = nan_value;
+            continue;
+        }
+        result.saturated += s > hi || s < lo;
+        *d_first = Fixed(*first);
+    }
+    return result;
+}
+
+/**
+ * @brief 固定小数点数の列 [ @a first, @a last ) を、浮動小数点数の列に変換して @a d_first に書き込みます
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param d_first 書き込み先の先頭へのポインタ
+ */
+template <class Fixed, class Floating>
+void to_floating(const Fixed* first, const Fixed* last, Floating* d_first) noexcept
+{
+    static_assert(std::is_floating_point_v<Floating>);
+    constexpr Floating inverse = detail::exp2<Floating>(-static_cast<int>(Fixed::fractional_bits));
+#if defined(__SSE2__)
+    if constexpr (detail::is_simd_convertible<Fixed, Floating>::value) {
+        for (; last - first >= 8; first += 8, d_first += 8) {
+            if constexpr (std::is_same_v<typename Fixed::value_type, std::int16_t>) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                detail::store4(d_first, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), inverse);
+                detail::store4(d_first + 4, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), inverse);
+            } else {
+                detail::store4(d_first, _mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), inverse);
+                detail::store4(d_first + 4, _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + 4)), inverse);
+            }
+        }
+    }
+#endif
+    for (; first != last; ++first, ++d_first) *d_first = static_cast<Floating>(first->raw()) * inverse;
+}
+
+} // namespace chap16_8_12
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+template <class F>
+double gb_per_second(double bytes, F f)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < 5; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return bytes / best * 1e-9;
+}
+
+template <class Fixed, class Floating>
+void run(const char* name, std::size_t n)
+{
+    namespace chap = TPLCXX17::chap16_8_12;
+
+    std::mt19937 engine(42);
+    std::uniform_real_distribution<Floating> dist(-2, 2);
+    std::vector<Floating> in(n), back(n);
+    for (Floating& x : in) x = dist(engine);
+    in[n / 2] = std::numeric_limits<Floating>::quiet_NaN();
+    in[n / 3] = std::numeric_limits<Floating>::infinity();
+
+    std::vector<Fixed> out(n);
+    const double bytes = static_cast<double>(n * (sizeof(Floating) + sizeof(Fixed)));
+    std::cout << name << " std::pow + std::round: " << gb_per_second(bytes, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            const Floating s = std::round(in[i] * std::pow(2, Fixed::fractional_bits));
+            out[i] = Fixed::from_raw(static_cast<typename Fixed::value_type>(std::clamp<Floating>(s != s ? 0 : s, Fixed::lowest().raw(), Fixed::max().raw())));
+        }
+    }) << " GB/s" << std::endl;
+    std::cout << name << " constructor: " << gb_per_second(bytes, [&] { for (std::size_t i = 0; i < n; ++i) out[i] = Fixed(in[i]); }) << " GB/s" << std::endl;
+
+    chap::conversion_result r;
+    std::cout << name << " to_fixed: " << gb_per_second(bytes, [&] { r = chap::to_fixed(in.data(), in.data() + n, out.data()); }) << " GB/s"
+        << " (nan " << r.nan << ", saturated " << r.saturated << ")" << std::endl;
+    std::cout << name << " to_floating: " << gb_per_second(bytes, [&] { chap::to_floating(out.data(), out.data() + n, back.data()); }) << " GB/s" << std::endl;
+}
+
+int main()
+{
+    namespace chap = TPLCXX17::chap16_8_11;
+    constexpr std::size_t n = std::size_t(1) << 24;
+    run<chap::fixed_point<2, 13>, float>("float -> Q2.13", n);
+    run<chap::fixed_point<7, 16>, float>("float -> Q7.16", n);
+    run<chap::fixed_point<15, 16>, double>("double -> Q15.16", n);
+}
+#endif
+#include <charconv>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <type_traits>
+
+namespace TPLCXX17 {
+//! chapter 16.8.13 namespace
+namespace chap16_8_13 {
+
+/**
+ * @brief 固定小数点数 @a x を 10 進数の文字列として [ @a first, @a last ) に書き込みます
+ * @param first 書き込み先の先頭へのポインタ
+ * @param last 書き込み先の終端へのポインタ
+ * @param x 固定小数点数
+ * @return std::to_chars と同じく、書き込んだ範囲の終端へのポインタとエラー。領域が足りない場合は { @a last, std::errc::value_too_large } を返します
+ * @note 値を正確に表す最も短い文字列を書き込みます。整数の場合は小数点を書き込みません
+ * @code
+ * void to_chars_sample()
+ * {
+ *      char buf[32];
+ *      auto r = TPLCXX17::chap16_8_13::to_chars(std::begin(buf), std::end(buf), TPLCXX17::chap16_8_11::fixed_point<2, 13>::epsilon());
+ *      [[maybe_unused]] std::string_view s(buf, r.ptr - buf); // "0.0001220703125"
+ * }
+ * @endcode
+ */
+template <std::size_t I, std::size_t F, bool S, chap16_8_11::overflow P>
+std::to_chars_result to_chars(char* first, char* last, chap16_8_11::fixed_point<I, F, S, P> x) noexcept
+{
+    typedef chap16_8_11::fixed_point<I, F, S, P> fixed_type;
+    typedef typename chap16_8_11::detail::wide<fixed_type::total_bits>::unsigned_type unsigned_type;
+    static_assert(F < 64, "fractional part must be narrower than 64 bits");
+
+    const bool negative = x.raw() < 0;
+    // 最小の値の符号を反転しても溢れないよう、広い型で絶対値を取る
+    const unsigned_type magnitude = negative ? unsigned_type(0) - static_cast<unsigned_type>(x.raw()) : static_cast<unsigned_type>(x.raw());
+    const unsigned_type mask = (unsigned_type(1) << F) - 1;
+    unsigned_type integer = magnitude >> F, fraction = magnitude & mask;
+
+    char digits[24]; // Number part は高々 64 ビット(20 桁)
+    char* p = std::end(digits);
+    do {
+        *--p = static_cast<char>('0' + integer % 10);
+        integer /= 10;
+    } while (integer != 0);
+
+    const std::size_t length = static_cast<std::size_t>(std::end(digits) - p) + negative;
+    if (static_cast<std::size_t>(last - first) < length) return { last, std::errc::value_too_large };
+    if (negative) *first++ = '-';
+    for (; p != std::end(digits); ++p) *first++ = *p;
+
+    if (fraction != 0) {
+        if (first == last) return { last, std::errc::value_too_large };
+        *first++ = '.';
+        do {
+            if (first == last) return { last, std::errc::value_too_large };
+            fraction *= 10;
+            *first++ = static_cast<char>('0' + (fraction >> F));
+            fraction &= mask;
+        } while (fraction != 0);
+    }
+    return { first, std::errc() };
+}
+
+/**
+ * @brief [ @a first, @a last ) の 10 進数の文字列を固定小数点数に変換します
+ * @param first 文字列の先頭へのポインタ
+ * @param last 文字列の終端へのポインタ
+ * @param x 変換した値の書き込み先
+ * @return std::from_chars と同じく、変換に用いなかった最初の文字へのポインタとエラー。
+ * 数値として解釈できない場合は std::errc::invalid_argument を、範囲外の場合は std::errc::result_out_of_range を返し、@a x を変更しません
+ * @note 受け付ける形式は、省略可能な '-' に続く 10 進数の整数部と、省略可能な '.' に続く小数部です(整数部と小数部の少なくとも一方は必要です)。
+ * 最も近い値に丸め、中間の値は正の無限大の方向に丸めます
+ */
+template <std::size_t I, std::size_t F, bool S, chap16_8_11::overflow P>
+std::from_chars_result from_chars(const char* first, const char* last, chap16_8_11::fixed_point<I, F, S, P>& x) noexcept
+{
+    typedef chap16_8_11::fixed_point<I, F, S, P> fixed_type;
+    typedef typename chap16_8_11::detail::wide<fixed_type::total_bits>::unsigned_type unsigned_type;
+    static_assert(F < 64, "fractional part must be narrower than 64 bits");
+    auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+
+    const char* p = first;
+    const bool negative = p != last && *p == '-';
+    if (negative) ++p;
+
+    // 整数部。表せる最大の値を超えた時点で範囲外とする
+    const unsigned_type limit = negative ? unsigned_type(0) - static_cast<unsigned_type>(fixed_type::lowest().raw()) : static_cast<unsigned_type>(fixed_type::max().raw());
+    unsigned_type integer = 0;
+    bool out_of_range = false, any_digit = false;
+    for (; p != last && is_digit(*p); ++p) {
+        any_digit = true;
+        if (!out_of_range) {
+            integer = integer * 10 + static_cast<unsigned_type>(*p - '0');
+            out_of_range = integer > (limit >> F);
+        }
+    }
+
+    // 小数部は n + 1 桁までを保持し、それより後ろは 0 でない桁があるかどうかのみを覚えておく
+    char fraction[F + 1];
+    std::size_t k = 0;
+    bool sticky = false;
+    if (p != last && *p == '.' && (any_digit || (p + 1 != last && is_digit(p[1])))) {
+        for (++p; p != last && is_digit(*p); ++p) {
+            any_digit = true;
+            if (k < F + 1) fraction[k++] = static_cast<char>(*p - '0');
+            else sticky |= *p != '0';
+        }
+    }
+    if (!any_digit) return { first, std::errc::invalid_argument };
+    if (out_of_range) return { p, std::errc::result_out_of_range };
+
+    // 小数部の桁が少なければ、整数 D と 10^k について D * 2^F / 10^k を直接求める。
+    // 多ければ、桁の列を 2 倍して繰り上がったビットを取り出すことを F 回繰り返す。
+    // いずれも、余りと 0.5 を比べた結果を compared に求める
+    constexpr std::size_t direct_digits = static_cast<std::size_t>((sizeof(unsigned_type) * CHAR_BIT - F - 2) * 0.30102999566398120);
+    unsigned_type bits = 0;
+    int compared = -1;
+    if (k <= direct_digits) {
+        unsigned_type numerator = 0, denominator = 1;
+        for (std::size_t j = 0; j < k; ++j) {
+            numerator = numerator * 10 + static_cast<unsigned_type>(fraction[j]);
+            denominator *= 10;
+        }
+        numerator <<= F;
+        bits = numerator / denominator;
+        const unsigned_type twice = numerator % denominator * 2;
+        compared = twice < denominator ? -1 : twice > denominator ? 1 : 0;
+    } else {
+        for (std::size_t i = 0; i < F; ++i) {
+            int carry = 0;
+            for (std::size_t j = k; j-- != 0;) {
+                const int v = fraction[j] * 2 + carry;
+                fraction[j] = static_cast<char>(v % 10);
+                carry = v / 10;
+            }
+            bits = bits << 1 | static_cast<unsigned_type>(carry);
+        }
+        compared = fraction[0] < 5 ? -1 : fraction[0] > 5 ? 1 : 0;
+        for (std::size_t j = 1; compared == 0 && j < k; ++j) compared = fraction[j] != 0;
+    }
+
+    // 中間の値は正の無限大の方向(負の値の場合は絶対値を小さくする方向)に丸める
+    if (compared == 0 && sticky) compared = 1;
+    if (compared > 0 || (compared == 0 && !negative)) ++bits;
+
+    const unsigned_type magnitude = (integer << F) + bits;
+    if (magnitude > limit) return { p, std::errc::result_out_of_range };
+    typedef typename fixed_type::value_type value_type;
+    x = fixed_type::from_raw(negative ? static_cast<value_type>(unsigned_type(0) - magnitude) : static_cast<value_type>(magnitude));
+    return { p, std::errc() };
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+inline std::to_chars_result to_chars(char* first, char* last, float x) noexcept { return std::to_chars(first, last, x); }
+inline std::to_chars_result to_chars(char* first, char* last, double x) noexcept { return std::to_chars(first, last, x); }
+inline std::from_chars_result from_chars(const char* first, const char* last, float& x) noexcept { return std::from_chars(first, last, x); }
+inline std::from_chars_result from_chars(const char* first, const char* last, double& x) noexcept { return std::from_chars(first, last, x); }
+#endif
+
+/**
+ * @class batch_result
+ * @brief 列をまとめて変換した結果
+ */
+template <class Pointer>
+struct batch_result {
+    Pointer ptr;         //!< 最後に変換し終えた値の直後へのポインタ
+    std::errc ec;        //!< エラー
+    std::size_t count;   //!< 変換し終えた値の数
+};
+
+/**
+ * @brief 値の列 [ @a vfirst, @a vlast ) を、各値の後に @a separator を挟みながら [ @a first, @a last ) に書き込みます
+ * @param first 書き込み先の先頭へのポインタ
+ * @param last 書き込み先の終端へのポインタ
+ * @param vfirst 値の列の先頭へのポインタ
+ * @param vlast 値の列の終端へのポインタ
+ * @param separator 各値の後に書き込む文字
+ * @return 最後に書き込み終えた値の直後へのポインタ、エラー、書き込み終えた値の数。領域が足りない場合のエラーは std::errc::value_too_large です
+ * @note 値の型は fixed_point、float、double のいずれかです。浮動小数点数は、読み戻したときに元の値と同じになる最も短い文字列となります
+ * @code
+ * void batch_to_chars_sample()
+ * {
+ *      const std::vector<float> v { 0.1f, 1e-7f, 3.f };
+ *      char buf[64];
+ *      auto r = TPLCXX17::chap16_8_13::to_chars(std::begin(buf), std::end(buf), v.data(), v.data() + v.size()); // "0.1\n1e-07\n3\n"
+ * }
+ * @endcode
+ */
+template <class T>
+batch_result<char*> to_chars(char* first, char* last, const T* vfirst, const T* vlast, char separator = '\n') noexcept
+{
+    std::size_t count = 0;
+    for (; vfirst != vlast; ++vfirst, ++count) {
+        const std::to_chars_result r = chap16_8_13::to_chars(first, last, *vfirst);
+        if (r.ec != std::errc() || r.ptr == last) return { first, std::errc::value_too_large, count };
+        *r.ptr = separator;
+        first = r.ptr + 1;
+    }
+    return { first, std::errc(), count };
+}
+
+/**
+ * @brief @a separator で区切られた文字列 [ @a first, @a last ) を、値の列として [ @a vfirst, @a vlast ) に読み込みます
+ * @param first 文字列の先頭へのポインタ
+ * @param last 文字列の終端へのポインタ
+ * @param vfirst 読み込み先の先頭へのポインタ
+ * @param vlast 読み込み先の終端へのポインタ
+ * @param separator 値を区切る文字
+ * @return 最後に読み込み終えた値(とその直後の区切り文字)の直後へのポインタ、エラー、読み込み終えた値の数
+ */
+template <class T>
+batch_result<const char*> from_chars(const char* first, const char* last, T* vfirst, T* vlast, char separator = '\n') noexcept
+{
+    std::size_t count = 0;
+    for (; vfirst != vlast && first != last; ++vfirst, ++count) {
+        const std::from_chars_result r = chap16_8_13::from_chars(first, last, *vfirst);
+        if (r.ec != std::errc()) return { first, r.ec, count };
+        if (r.ptr != last && *r.ptr != separator) return { first, std::errc::invalid_argument, count };
+        first = r.ptr == last ? r.ptr : r.ptr + 1;
+    }
+    return { first, std::errc(), count };
+}
+
+} // namespace chap16_8_13
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <vector>
+
+template <class F>
+double seconds(F f)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < 3; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+template <class T, class Stream>
+void run(const char* name, const std::vector<T>& v, Stream stream)
+{
+    namespace chap = TPLCXX17::chap16_8_13;
+    const double n = static_cast<double>(v.size());
+
+    const double ios = seconds([&] {
+        std::ostringstream os;
+        for (const T& x : v) stream(os, x) << '\n';
+    });
+
+    std::vector<char> buffer(v.size() * 48);
+    chap::batch_result<char*> written {};
+    const double tc = seconds([&] { written = chap::to_chars(buffer.data(), buffer.data() + buffer.size(), v.data(), v.data() + v.size()); });
+
+    std::vector<T> back(v.size());
+    chap::batch_result<const char*> read {};
+    const double fc = seconds([&] { read = chap::from_chars(buffer.data(), written.ptr, back.data(), back.data() + back.size()); });
+    const bool round_trip = read.count == v.size() && std::memcmp(v.data(), back.data(), v.size() * sizeof(T)) == 0;
+
+    std::cout << name << ": iostream " << n / ios * 1e-6 << " M values/s, to_chars " << n / tc * 1e-6 << " M values/s"
+        << " (" << static_cast<double>(written.ptr - buffer.data()) / n << " bytes/value), from_chars " << n / fc * 1e-6 << " M values/s, round trip "
+        << (round_trip ? "ok" : "failed") << std::endl;
+}
+
+int main()
+{
+    typedef TPLCXX17::chap16_8_11::fixed_point<2, 13> q2_13;
+    constexpr std::size_t n = 1 << 20;
+
+    std::mt19937 engine(42);
+    std::uniform_real_distribution<double> dist(-4, 4);
+    std::vector<q2_13> q(n);
+    std::vector<float> f(n);
+    std::vector<double> d(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        d[i] = dist(engine);
+        f[i] = static_cast<float>(d[i]);
+        q[i] = q2_13(d[i]);
+    }
+
+    run("Q2.13", q, [](std::ostream& os, q2_13 x) -> std::ostream& { return os << x.raw() / std::pow(2, q2_13::fractional_bits); });
+    run("float", f, [](std::ostream& os, float x) -> std::ostream& { return os << std::setprecision(std::numeric_limits<float>::max_digits10) << x; });
+    run("double", d, [](std::ostream& os, double x) -> std::ostream& { return os << std::setprecision(std::numeric_limits<double>::max_digits10) << x; });
+}
+#endif
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace TPLCXX17 {
+//! chapter 16.8.14 namespace
+namespace chap16_8_14 {
+
+/**
+ * @class ieee754
+ * @brief IEEE 754 の二進浮動小数点数の形式の各部のビット数
+ */
+template <class T>
+struct ieee754;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <>
+struct ieee754<float> {
+    typedef std::uint32_t bits_type;
+    static constexpr unsigned exponent_bits = 8, mantissa_bits = 23;
+};
+
+template <>
+struct ieee754<double> {
+    typedef std::uint64_t bits_type;
+    static constexpr unsigned exponent_bits = 11, mantissa_bits = 52;
+};
+
+namespace detail {
+
+template <class T>
+typename ieee754<T>::bits_type to_bits(T x) noexcept
+{
+    static_assert(std::numeric_limits<T>::is_iec559);
+    typename ieee754<T>::bits_type b;
+    std::memcpy(&b, &x, sizeof b);
+    return b;
+}
+
+template <class T>
+constexpr typename ieee754<T>::bits_type sign_mask = typename ieee754<T>::bits_type(1) << (sizeof(T) * CHAR_BIT - 1);
+
+template <class T>
+constexpr unsigned exponent_bins = 1u << ieee754<T>::exponent_bits;
+
+template <class T>
+constexpr int exponent_bias = (1 << (ieee754<T>::exponent_bits - 1)) - 1;
+
+} // namespace detail
+#endif
+
+/**
+ * @class print_bit
+ * @brief 16.8.3 の print_bit を float と double に一般化したもので、符号部、指数部、仮数部を空白で区切って出力します
+ */
+template <class T>
+class print_bit {
+public:
+    constexpr explicit print_bit(T x) noexcept : data_(x) {}
+private:
+    T data_;
+
+    friend std::ostream& operator<<(std::ostream& os, const print_bit& this_)
+    {
+        typedef ieee754<T> traits;
+        const auto b = detail::to_bits(this_.data_);
+        return os << (b >> (traits::exponent_bits + traits::mantissa_bits))
+            << ' ' << std::bitset<traits::exponent_bits>(b >> traits::mantissa_bits)
+            << ' ' << std::bitset<traits::mantissa_bits>(b);
+    }
+};
+
+/**
+ * @brief ビット列の順序が値の大小と同じ順序となる符号なし整数に写したときの、@a a と @a b の差を返します
+ * @param a 値
+ * @param b 値
+ * @return ULP の差。+0 と -0 の差は 0 です
+ * @note いずれかが NaN の場合の結果は意味を持ちません
+ */
+template <class T>
+std::uint64_t ulp_distance(T a, T b) noexcept
+{
+    typedef typename ieee754<T>::bits_type bits_type;
+    constexpr bits_type sign = detail::sign_mask<T>;
+    auto key = [](bits_type x) -> bits_type { return x & sign ? sign - (x & ~sign) : sign + x; };
+    const bits_type ka = key(detail::to_bits(a)), kb = key(detail::to_bits(b));
+    return ka > kb ? ka - kb : kb - ka;
+}
+
+/**
+ * @class outlier
+ * @brief 報告する外れ値
+ */
+template <class T>
+struct outlier {
+    std::uint64_t index;     //!< 列の先頭からの位置
+    T value;                 //!< 値
+    T other;                 //!< 比較した相手の値(scan の場合は value と同じ)
+    std::uint64_t distance;  //!< ULP の差(scan の場合は 0)
+};
+
+/**
+ * @class scan_report
+ * @brief scan による検査の結果
+ */
+template <class T>
+struct scan_report {
+    static constexpr std::size_t max_outliers = 8;
+
+    std::uint64_t values = 0;         //!< 値の数
+    std::uint64_t nan = 0;            //!< NaN の数
+    std::uint64_t infinity = 0;       //!< 無限大の数
+    std::uint64_t subnormal = 0;      //!< 非正規化数の数
+    std::uint64_t zero = 0;           //!< ゼロ(負のゼロを含む)の数
+    std::uint64_t negative_zero = 0;  //!< 負のゼロの数
+    std::uint64_t negative = 0;       //!< 符号部が 1 である値の数
+    std::array<std::uint64_t, detail::exponent_bins<T>> exponents {}; //!< 指数部の値ごとの数
+    std::vector<outlier<T>> outliers; //!< 先頭から順に高々 max_outliers 個の NaN と無限大
+
+    /**
+     * @brief 直後の区間の結果を合わせます
+     * @param other 直後の区間の結果
+     */
+    void merge(const scan_report& other)
+    {
+        values += other.values;
+        nan += other.nan;
+        infinity += other.infinity;
+        subnormal += other.subnormal;
+        zero += other.zero;
+        negative_zero += other.negative_zero;
+        negative += other.negative;
+        for (std::size_t i = 0; i < exponents.size(); ++i) exponents[i] += other.exponents[i];
+        for (const outlier<T>& o : other.outliers) {
+            if (outliers.size() == max_outliers) break;
+            outliers.push_back(o);
+        }
+    }
+};
+
+/**
+ * @class ulp_report
+ * @brief compare による比較の結果
+ */
+template <class T>
+struct ulp_report {
+    static constexpr std::size_t max_outliers = 8;
+
+    std::uint64_t values = 0;        //!< 比較した値の数
+    std::uint64_t identical = 0;     //!< ビット列が一致した値の数
+    std::uint64_t nan_mismatch = 0;  //!< 一方のみが NaN である値の数
+    std::uint64_t max_ulp = 0;       //!< NaN を除いた ULP の差の最大値
+    std::array<std::uint64_t, 65> distances {}; //!< distances[k] は、ULP の差 d の有効なビット数が k である(つまり 2^(k-1) <= d < 2^k の)値の数
+    std::vector<outlier<T>> outliers; //!< ULP の差が大きい順に高々 max_outliers 個の値(差が等しい場合は先頭に近いもの)
+
+    /**
+     * @brief ULP の差が大きい値を外れ値の候補として加えます
+     * @param o 候補
+     */
+    void add_outlier(const outlier<T>& o)
+    {
+        if (outliers.size() == max_outliers && outliers.back().distance >= o.distance) return;
+        auto it = std::upper_bound(outliers.begin(), outliers.end(), o, [](const outlier<T>& x, const outlier<T>& y) { return x.distance > y.distance; });
+        outliers.insert(it, o);
+        if (outliers.size() > max_outliers) outliers.pop_back();
+    }
+
+    /**
+     * @brief 直後の区間の結果を合わせます
+     * @param other 直後の区間の結果
+     */
+    void merge(const ulp_report& other)
+    {
+        values += other.values;
+        identical += other.identical;
+        nan_mismatch += other.nan_mismatch;
+        max_ulp = std::max(max_ulp, other.max_ulp);
+        for (std::size_t i = 0; i < distances.size(); ++i) distances[i] += other.distances[i];
+        for (const outlier<T>& o : other.outliers) add_outlier(o);
+    }
+};
+
+/**
+ * @class mapped_file
+ * @brief 読み込み専用でメモリに対応付けたファイル
+ * @note POSIX 環境では mmap を用います。それ以外の環境では、ファイル全体をメモリに読み込みます
+ */
+class mapped_file {
+public:
+    /**
+     * @brief ファイルをメモリに対応付けます
+     * @param path ファイルのパス
+     * @exception std::system_error ファイルを開けなかった場合
+     */
+    explicit mapped_file(const std::string& path)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), __func__ + std::string(": ") + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            const int e = errno;
+            ::close(fd);
+            throw std::system_error(e, std::generic_category(), __func__ + std::string(": ") + path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ != 0) {
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                const int e = errno;
+                ::close(fd);
+                throw std::system_error(e, std::generic_category(), __func__ + std::string(": ") + path);
+            }
+#ifdef MADV_SEQUENTIAL
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+#endif
+            data_ = static_cast<const unsigned char*>(p);
+        }
+        ::close(fd);
+#else
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), __func__ + std::string(": ") + path);
+        buffer_.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        data_ = reinterpret_cast<const unsigned char*>(buffer_.data());
+        size_ = buffer_.size();
+#endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if (data_) ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    }
+
+    const unsigned char* data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+
+    /**
+     * @brief ファイルの内容を T の列とみなしたときの先頭を返します
+     * @return 先頭へのポインタ
+     */
+    template <class T>
+    const T* begin() const noexcept { return reinterpret_cast<const T*>(data_); }
+
+    /**
+     * @brief ファイルの内容を T の列とみなしたときの終端を返します
+     * @return 終端へのポインタ。ファイルの大きさが sizeof(T) の倍数でない場合、末尾の端数は含みません
+     */
+    template <class T>
+    const T* end() const noexcept { return begin<T>() + size_ / sizeof(T); }
+private:
+    const unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+#if !defined(__unix__) && !defined(__APPLE__)
+    std::vector<char> buffer_;
+#endif
+};
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail {
+
+template <class T>
+void classify(T x, std::uint64_t index, scan_report<T>& r) noexcept
+{
+    typedef ieee754<T> traits;
+    typedef typename traits::bits_type bits_type;
+    constexpr bits_type mantissa_mask = (bits_type(1) << traits::mantissa_bits) - 1;
+
+    const bits_type b = to_bits(x), magnitude = b & ~sign_mask<T>;
+    const unsigned e = static_cast<unsigned>(magnitude >> traits::mantissa_bits);
+    ++r.exponents[e];
+    r.negative += b >> (sizeof(T) * CHAR_BIT - 1);
+    if (e == 0) {
+        if (magnitude == 0) {
+            ++r.zero;
+            r.negative_zero += b != 0;
+        } else {
+            ++r.subnormal;
+        }
+    } else if (e == exponent_bins<T> - 1) {
+        if (magnitude & mantissa_mask) ++r.nan;
+        else ++r.infinity;
+        if (r.outliers.size() < r.max_outliers) r.outliers.push_back({ index, x, x, 0 });
+    }
+}
+
+#if defined(__SSE2__)
+// 4 つの値の上位 32 ビットと、下位 32 ビットが 0 でないかどうかのマスクを読み込む
+inline void load4(const float* p, __m128i& high, __m128i& low_nonzero) noexcept
+{
+    high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    low_nonzero = _mm_setzero_si128();
+}
+
+inline void load4(const double* p, __m128i& high, __m128i& low_nonzero) noexcept
+{
+    const __m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(p)), b = _mm_loadu_ps(reinterpret_cast<const float*>(p + 2));
+    high = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    const __m128i low = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    low_nonzero = _mm_andnot_si128(_mm_cmpeq_epi32(low, _mm_setzero_si128()), _mm_set1_epi32(-1));
+}
+
+inline std::uint64_t horizontal_sum(__m128i v) noexcept
+{
+    alignas(16) std::uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return std::uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+}
+#endif
+
+template <class T>
+scan_report<T> scan_serial(const T* first, const T* last, std::uint64_t offset)
+{
+    scan_report<T> r;
+    r.values = static_cast<std::uint64_t>(last - first);
+    const T* p = first;
+#if defined(__SSE2__)
+    // 上位 32 ビットのうちの仮数部のビット数
+    constexpr unsigned high_mantissa_bits = ieee754<T>::mantissa_bits - (sizeof(T) - 4) * CHAR_BIT;
+    const __m128i abs_mask = _mm_set1_epi32(0x7fffffff), sign = _mm_set1_epi32(static_cast<int>(0x80000000u)), zero = _mm_setzero_si128();
+    const __m128i inf = _mm_set1_epi32(static_cast<int>((exponent_bins<T> - 1) << high_mantissa_bits));
+    const __m128i min_normal = _mm_set1_epi32(static_cast<int>(1u << high_mantissa_bits));
+    // 指数部のヒストグラムは、連続する加算が同じ要素に依存しないよう、レーンごとに分けて数える
+    std::array<std::array<std::uint32_t, exponent_bins<T>>, 4> histogram {};
+    // 32 ビットのカウンタが溢れないよう、1 << 24 個の値ごとにまとめる
+    constexpr std::size_t block = std::size_t(1) << 24;
+
+    while (last - p >= 4) {
+        const T* block_last = p + std::min<std::size_t>(block, static_cast<std::size_t>(last - p) / 4 * 4);
+        __m128i nan_count = zero, inf_count = zero, subnormal_count = zero, zero_count = zero, negative_zero_count = zero, negative_count = zero;
+        for (; p != block_last; p += 4) {
+            __m128i high, low_nonzero;
+            load4(p, high, low_nonzero);
+            const __m128i magnitude = _mm_and_si128(high, abs_mask);
+            const __m128i exponent_max = _mm_cmpeq_epi32(magnitude, inf);
+            const __m128i is_nan = _mm_or_si128(_mm_cmpgt_epi32(magnitude, inf), _mm_and_si128(exponent_max, low_nonzero));
+            const __m128i is_inf = _mm_andnot_si128(low_nonzero, exponent_max);
+            const __m128i is_zero = _mm_andnot_si128(low_nonzero, _mm_cmpeq_epi32(magnitude, zero));
+            const __m128i is_negative_zero = _mm_andnot_si128(low_nonzero, _mm_cmpeq_epi32(high, sign));
+            const __m128i is_subnormal = _mm_andnot_si128(is_zero, _mm_cmplt_epi32(magnitude, min_normal));
+
+            // 比較の結果は真のとき -1 であるから、引くことで数える
+            nan_count = _mm_sub_epi32(nan_count, is_nan);
+            inf_count = _mm_sub_epi32(inf_count, is_inf);
+            subnormal_count = _mm_sub_epi32(subnormal_count, is_subnormal);
+            zero_count = _mm_sub_epi32(zero_count, is_zero);
+            negative_zero_count = _mm_sub_epi32(negative_zero_count, is_negative_zero);
+            negative_count = _mm_sub_epi32(negative_count, _mm_cmplt_epi32(high, zero));
+
+            alignas(16) std::uint32_t e[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(e), _mm_srli_epi32(magnitude, high_mantissa_bits));
+            ++histogram[0][e[0]];
+            ++histogram[1][e[1]];
+            ++histogram[2][e[2]];
+            ++histogram[3][e[3]];
+
+            if (r.outliers.size() < r.max_outliers && _mm_movemask_epi8(_mm_or_si128(is_nan, is_inf))) {
+                for (std::size_t i = 0; i < 4 && r.outliers.size() < r.max_outliers; ++i) {
+                    const T x = p[i];
+                    const auto magnitude_bits = to_bits(x) & ~sign_mask<T>;
+                    if ((magnitude_bits >> ieee754<T>::mantissa_bits) == exponent_bins<T> - 1) {
+                        r.outliers.push_back({ offset + static_cast<std::uint64_t>(p - first) + i, x, x, 0 });
+                    }
+                }
+            }
+        }
+        r.nan += horizontal_sum(nan_count);
+        r.infinity += horizontal_sum(inf_count);
+        r.subnormal += horizontal_sum(subnormal_count);
+        r.zero += horizontal_sum(zero_count);
+        r.negative_zero += horizontal_sum(negative_zero_count);
+        r.negative += horizontal_sum(negative_count);
+        for (std::size_t i = 0; i < r.exponents.size(); ++i) {
+            r.exponents[i] += std::uint64_t(histogram[0][i]) + histogram[1][i] + histogram[2][i] + histogram[3][i];
+        }
+        histogram = {};
+    }
+#endif
+    for (; p != last; ++p) classify(*p, offset + static_cast<std::uint64_t>(p - first), r);
+    return r;
+}
+
+template <class T>
+ulp_report<T> compare_serial(const T* first1, const T* last1, const T* first2, std::uint64_t offset)
+{
+    ulp_report<T> r;
+    r.values = static_cast<std::uint64_t>(last1 - first1);
+    // 多くの値が一致する場合に備え、ブロックごとにビット列が一致するかを先に調べる
+    constexpr std::size_t block = 1024;
+    for (const T* p = first1; p != last1;) {
+        const std::size_t n = std::min<std::size_t>(block, static_cast<std::size_t>(last1 - p));
+        const T* q = first2 + (p - first1);
+        if (std::memcmp(p, q, n * sizeof(T)) == 0) {
+            r.identical += n;
+            r.distances[0] += n;
+            p += n;
+            continue;
+        }
+        for (const T* l = p + n; p != l; ++p, ++q) {
+            if (to_bits(*p) == to_bits(*q)) {
+                ++r.identical;
+                ++r.distances[0];
+                continue;
+            }
+            const bool nan1 = *p != *p, nan2 = *q != *q;
+            if (nan1 || nan2) {
+                if (nan1 != nan2) {
+                    ++r.nan_mismatch;
+                    r.add_outlier({ offset + static_cast<std::uint64_t>(p - first1), *p, *q, std::numeric_limits<std::uint64_t>::max() });
+                }
+                continue;
+            }
+            const std::uint64_t d = ulp_distance(*p, *q);
+            std::size_t width = 0;
+            for (std::uint64_t x = d; x != 0; x >>= 1) ++width;
+            ++r.distances[width];
+            r.max_ulp = std::max(r.max_ulp, d);
+            if (d != 0) r.add_outlier({ offset + static_cast<std::uint64_t>(p - first1), *p, *q, d });
+        }
+    }
+    return r;
+}
+
+} // namespace detail
+#endif
+
+/**
+ * @brief [ @a first, @a last ) の値を分類し、指数部の分布を求めます
+ * @param first 先頭へのポインタ
+ * @param last 終端へのポインタ
+ * @param pool 要素の数が chap16_7_9::parallel_threshold 以上の場合に用いるスレッドプール
+ * @return 検査の結果
+ */
+template <class T>
+scan_report<T> scan(const T* first, const T* last, chap16_7_9::thread_pool& pool = chap16_7_9::thread_pool::instance())
+{
+    if (static_cast<std::size_t>(last - first) < chap16_7_9::parallel_threshold || pool.size() < 2) return detail::scan_serial(first, last, 0);
+
+    std::vector<scan_report<T>> partial = chap16_7_9::parallel_chunks(pool, first, last, [first](const T* f, const T* l) {
+        return detail::scan_serial(f, l, static_cast<std::uint64_t>(f - first));
+    });
+    scan_report<T> r = std::move(partial.front());
+    for (std::size_t i = 1; i < partial.size(); ++i) r.merge(partial[i]);
+    return r;
+}
+
+/**
+ * @brief [ @a first1, @a last1 ) と @a first2 から始まる同じ長さの列の、対応する値の ULP の差を求めます
+ * @param first1 一つ目の列の先頭へのポインタ
+ * @param last1 一つ目の列の終端へのポインタ
+ * @param first2 二つ目の列の先頭へのポインタ
+ * @param pool 要素の数が chap16_7_9::parallel_threshold 以上の場合に用いるスレッドプール
+ * @return 比較の結果
+ * @note 両方が NaN である値は、ビット列が異なっても差を持たないものとします。一方のみが NaN である値は最も大きな外れ値として報告します
+ */
+template <class T>
+ulp_report<T> compare(const T* first1, const T* last1, const T* first2, chap16_7_9::thread_pool& pool = chap16_7_9::thread_pool::instance())
+{
+    if (static_cast<std::size_t>(last1 - first1) < chap16_7_9::parallel_threshold || pool.size() < 2) return detail::compare_serial(first1, last1, first2, 0);
+
+    std::vector<ulp_report<T>> partial = chap16_7_9::parallel_chunks(pool, first1, last1, [first1, first2](const T* f, const T* l) {
+        return detail::compare_serial(f, l, first2 + (f - first1), static_cast<std::uint64_t>(f - first1));
+    });
+    ulp_report<T> r = std::move(partial.front());
+    for (std::size_t i = 1; i < partial.size(); ++i) r.merge(partial[i]);
+    return r;
+}
+
+/**
+ * @brief 検査の結果を出力します
+ * @note 指数部のヒストグラムは、ゼロと非正規化数、無限大と NaN を除き、連続する指数をまとめた高々 32 行で出力します。外れ値のみ、そのビット列を print_bit によって出力します
+ */
+template <class T>
+std::ostream& operator<<(std::ostream& os, const scan_report<T>& r)
+{
+    os << "values " << r.values << ", nan " << r.nan << ", inf " << r.infinity << ", subnormal " << r.subnormal
+        << ", zero " << r.zero << " (-0 " << r.negative_zero << "), negative " << r.negative << '\n';
+
+    constexpr unsigned bins = detail::exponent_bins<T>, group = bins / 32;
+    for (unsigned lo = 0; lo < bins; lo += group) {
+        std::uint64_t count = 0;
+        for (unsigned e = std::max(lo, 1u); e < std::min(lo + group, bins - 1); ++e) count += r.exponents[e];
+        if (count == 0) continue;
+        os << "  2^[" << static_cast<int>(std::max(lo, 1u)) - detail::exponent_bias<T> << ", "
+            << static_cast<int>(std::min(lo + group, bins - 1) - 1) - detail::exponent_bias<T> << "]: " << count << '\n';
+    }
+    for (const outlier<T>& o : r.outliers) os << "  [" << o.index << "] " << o.value << ' ' << print_bit<T>(o.value) << '\n';
+    return os;
+}
+
+/**
+ * @brief 比較の結果を出力します
+ * @note ULP の差の分布は、差の有効なビット数ごとに出力します。外れ値のみ、そのビット列を print_bit によって出力します
+ */
+template <class T>
+std::ostream& operator<<(std::ostream& os, const ulp_report<T>& r)
+{
+    os << "values " << r.values << ", identical " << r.identical << ", nan mismatch " << r.nan_mismatch << ", max ulp " << r.max_ulp << '\n';
+    for (std::size_t k = 1; k < r.distances.size(); ++k) {
+        if (r.distances[k] == 0) continue;
+        os << "  ulp [" << (std::uint64_t(1) << (k - 1)) << ", " << (k == 64 ? std::numeric_limits<std::uint64_t>::max() : (std::uint64_t(1) << k) - 1) << "]: " << r.distances[k] << '\n';
+    }
+    for (const outlier<T>& o : r.outliers) {
+        os << "  [" << o.index << "] " << o.value << " vs " << o.other << '\n'
+           << "    " << print_bit<T>(o.value) << '\n'
+           << "    " << print_bit<T>(o.other) << '\n';
+    }
+    return os;
+}
+
+} // namespace chap16_8_14
+} // namespace TPLCXX17
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+template <class T>
+int run(int argc, char** argv)
+{
+    namespace chap = TPLCXX17::chap16_8_14;
+    const chap::mapped_file a(argv[2]);
+    const auto start = std::chrono::steady_clock::now();
+    if (argc == 3) {
+        std::cout << chap::scan(a.begin<T>(), a.end<T>());
+    } else {
+        const chap::mapped_file b(argv[3]);
+        if (a.size() != b.size()) {
+            std::cerr << "sizes differ: " << a.size() << " vs " << b.size() << std::endl;
+            return 1;
+        }
+        std::cout << chap::compare(a.begin<T>(), a.end<T>(), b.begin<T>());
+    }
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << static_cast<double>(a.size()) * (argc - 2) / s * 1e-9 << " GB/s" << std::endl;
+    return 0;
+}
+
+template <class T>
+void write(const std::filesystem::path& path, const std::vector<T>& v)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+int main(int argc, char** argv)
+{
+    namespace chap = TPLCXX17::chap16_8_14;
+    if (argc == 3 || argc == 4) {
+        const std::string type = argv[1];
+        if (type == "float32") return run<float>(argc, argv);
+        if (type == "float64") return run<double>(argc, argv);
+    }
+    if (argc != 1) {
+        std::cerr << "usage: " << argv[0] << " float32|float64 file [file]" << std::endl;
+        return 1;
+    }
+
+    constexpr std::size_t n = std::size_t(1) << 26;
+    std::mt19937 engine(42);
+    std::lognormal_distribution<float> dist(0, 4);
+    std::vector<float> v(n);
+    for (float& x : v) x = engine() % 2 ? dist(engine) : -dist(engine);
+    for (std::size_t i = 0; i < 100; ++i) v[engine() % n] = std::numeric_limits<float>::denorm_min() * static_cast<float>(engine() % 1000 + 1);
+    for (std::size_t i = 0; i < 10; ++i) v[engine() % n] = -0.f;
+    v[engine() % n] = std::numeric_limits<float>::infinity();
+    v[engine() % n] = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<float> w = v;
+    for (std::size_t i = 0; i < n / 1000; ++i) {
+        float& x = w[engine() % n];
+        for (unsigned k = engine() % 4 + 1; k != 0; --k) x = std::nextafter(x, std::numeric_limits<float>::infinity());
+    }
+    w[engine() % n] *= 1.001f;
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::filesystem::path pa = dir / "chap16_8_14_a.bin", pb = dir / "chap16_8_14_b.bin";
+    write(pa, v);
+    write(pb, w);
+    std::string sa = pa.string(), sb = pb.string();
+    char type[] = "float32";
+    char* scan_args[] = { argv[0], type, sa.data() };
+    char* compare_args[] = { argv[0], type, sa.data(), sb.data() };
+    run<float>(3, scan_args);
+    run<float>(4, compare_args);
+    std::filesystem::remove(pa);
+    std::filesystem::remove(pb);
+}
 #endif
 /*@}*/